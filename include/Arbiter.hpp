@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Bus.hpp"
+
+// -----------------------------------------------------
+//    BUS ARBITERS                                     |
+// -----------------------------------------------------
+//  -- hold the requests waiting for the bus and decide which one is granted next
+//  -- requests arrive stamped with issue_time and source_id (see Bus::request_grant)
+struct IArbiter {
+    virtual void push(BusReq req) = 0;
+    // next request to grant; only called when !empty()
+    virtual BusReq pop(uint64_t now) = 0;
+    virtual bool empty() const = 0;
+    virtual std::string name() const = 0;
+    virtual ~IArbiter() = default;
+};
+
+// ---------------- FIFO (default) ---------------------
+class FIFOArbiter : public IArbiter {
+public:
+    void push(BusReq req) override { queue.push_back(std::move(req)); }
+    BusReq pop(uint64_t now) override;
+    bool empty() const override { return queue.empty(); }
+    std::string name() const override { return "fifo"; }
+
+private:
+    std::deque<BusReq> queue;
+};
+
+// ---------------- Round robin per source -------------
+//  -- one FIFO per source; grants rotate over sources with pending requests
+class RoundRobinArbiter : public IArbiter {
+public:
+    void push(BusReq req) override;
+    BusReq pop(uint64_t now) override;
+    bool empty() const override { return pending == 0; }
+    std::string name() const override { return "round-robin"; }
+
+private:
+    std::vector<std::deque<BusReq>> queues;   // indexed by source_id
+    size_t next    = 0;
+    size_t pending = 0;
+};
+
+// ---------------- Fixed priority by type -------------
+//  -- 'order' lists request types from highest to lowest priority;
+//     FIFO within a type
+class FixedPriorityArbiter : public IArbiter {
+public:
+    // default: INVALIDATE, SNOOP_WRITE, SNOOP_READ, WRITE_MISS_SERVICE, READ_MISS_SERVICE
+    FixedPriorityArbiter();
+    explicit FixedPriorityArbiter(std::vector<BusReqType> order);
+    void push(BusReq req) override;
+    BusReq pop(uint64_t now) override;
+    bool empty() const override { return pending == 0; }
+    std::string name() const override { return "fixed-priority"; }
+
+private:
+    std::vector<BusReqType> order;
+    std::deque<BusReq> queues[5];             // indexed by BusReqType
+    size_t pending = 0;
+};
+
+// ---------------- Weighted fair queuing --------------
+//  -- each request gets a virtual finish tag
+//       F = max(V, last finish of its source) + max(delay, 1) / weight(source)
+//     and the smallest tag is granted next (V = tag of the last grant)
+//  -- weights are indexed by source_id; missing weights default to 1
+class WeightedFairArbiter : public IArbiter {
+public:
+    explicit WeightedFairArbiter(std::vector<double> weights = {});
+    void push(BusReq req) override;
+    BusReq pop(uint64_t now) override;
+    bool empty() const override { return pending == 0; }
+    std::string name() const override { return "weighted-fair"; }
+
+private:
+    std::vector<double> weights;
+    std::vector<std::deque<std::pair<double, BusReq>>> queues;   // per source: (finish tag, request)
+    std::vector<double> last_finish;
+    double virtual_time = 0.0;
+    size_t pending = 0;
+};
+
+// ---------------- Age based anti-starvation ----------
+//  -- effective priority = type priority + waiting time / aging_quantum,
+//     where type priority follows the FixedPriorityArbiter default order
+//     (INVALIDATE = 4 ... READ_MISS_SERVICE = 0)
+//  -- a low priority request that waited long enough overtakes fresh
+//     high priority ones, so no source or type starves; ties go to the oldest
+class AgeBasedArbiter : public IArbiter {
+public:
+    explicit AgeBasedArbiter(uint64_t aging_quantum = 16);
+    void push(BusReq req) override { queue.push_back(std::move(req)); }
+    BusReq pop(uint64_t now) override;
+    bool empty() const override { return queue.empty(); }
+    std::string name() const override { return "age-based"; }
+
+private:
+    uint64_t aging_quantum;
+    std::deque<BusReq> queue;   // arrival order
+};
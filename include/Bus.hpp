@@ -1,12 +1,20 @@
 #pragma once
+#include <coroutine>
 #include <cstdint>
 #include <vector>
-#include <deque>
 #include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
 #include "EventSimulator.hpp"
 #include "Logger.hpp"
+#include "Stats.hpp"
+#include "SimTask.hpp"
+#include "Memory.hpp"
 
 class ICache; // forward declaration
+class BusTraceWriter;
+struct IArbiter;
               //
 enum class BusReqType {
     SNOOP_READ,
@@ -21,6 +29,9 @@ struct BusReq {
     ICache* source = nullptr;
     uint64_t addr = 0;
     uint64_t delay = 0;     // latency for this request
+    uint64_t issue_time = 0; // time at which grant was requested (set by Bus)
+    uint16_t source_id = 0;  // registration index of source (set by Bus, or by trace replay)
+    bool c2c = false;        // data service is served cache-to-cache, not by memory
     std::function<void(bool)> callback = nullptr; // invoked when request ends
     BusReq() = default; 
     BusReq(BusReqType t, ICache* src, uint64_t addr, uint64_t delay)
@@ -30,24 +41,60 @@ struct BusReq {
 class Bus {
 public:
     Bus(EventSimulator& sim, Logger& logger);
+    ~Bus();
 
     // Register a cache with the bus 
     void register_cache(ICache* cache);
 
     // Request for bus access 
     //  -- if bus is free, start immediately
-    //  -- else queues the request 
+    //  -- else queues the request in the arbiter 
     // callback is invoked with success status when the request completes 
     void request_grant(const BusReq& req);
 
+    // Memory model for data services not served cache-to-cache
+    // (nullptr --> use the latency carried in the request)
+    void set_memory(IMemory* mem) { memory = mem; }
+
+    // Arbitration policy for queued requests (default: FIFO)
+    void set_arbiter(std::unique_ptr<IArbiter> arb);
+
+    // Record every request_grant() into a bus trace (nullptr --> off)
+    void set_capture(BusTraceWriter* writer) { capture = writer; }
+
+    // co_await bus.grant(req) --> queues the request like request_grant() and
+    // resumes the awaiting coroutine with the success status when it ends
+    struct GrantAwaiter {
+        Bus& bus;
+        BusReq req;
+        bool success = false;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            req.callback = [this, h](bool ok){ success = ok; h.resume(); };
+            bus.request_grant(req);
+        }
+        bool await_resume() const noexcept { return success; }
+    };
+    GrantAwaiter grant(BusReq req) { return GrantAwaiter{*this, std::move(req)}; }
+
+    // Queueing delay (request_grant --> start of processing) report, overall and per source
+    void print_stats(std::ostream& os) const;
+
 private:
     EventSimulator& sim;
     Logger& logger;
     std::vector<ICache*> caches;
+    IMemory* memory = nullptr;
+    BusTraceWriter* capture = nullptr;
 
-    std::deque<BusReq> queue;
+    std::unique_ptr<IArbiter> arbiter;
     bool bus_busy = false;
 
+    LatencyHistogram queue_delay;
+    std::vector<LatencyHistogram> source_wait;   // indexed by source_id
+
+    std::string source_name(const BusReq& req) const;
+
     // Process next head of the queue 
     void process_next();
 
@@ -55,8 +102,11 @@ private:
     void execute_snoop(const BusReq& req);
 
     // Execute a data service request (helper for READ_MISS_SERVICE / WRITE_MISS_SERVICE)
-    void execute_data_service(const BusReq& req);
+    SimTask execute_data_service(BusReq req);
 
     // Execute an Invalidate broadcast 
     void execute_invalidate(const BusReq& req);
+
+    // Callback + hand over to the next request once all broadcast targets responded 
+    void complete_broadcast(const BusReq& req, int targets, bool result);
 };
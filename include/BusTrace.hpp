@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "Bus.hpp"
+#include "EventSimulator.hpp"
+
+// -----------------------------------------------------
+//    BUS TRACE                                        |
+// -----------------------------------------------------
+//  -- compact binary stream of every BusReq seen by Bus::request_grant
+//  -- header: "BUSTRC" + version byte
+//  -- record: 1 byte type (bits 0-2) | cache-to-cache flag (bit 3),
+//             then LEB128 varints of source id, issue time delta,
+//             zig-zag address delta and delay
+//  -- deltas are against the previous record, so a typical record is 4-8 bytes
+
+struct BusTraceRecord {
+    BusReqType type     = BusReqType::SNOOP_READ;
+    bool     c2c        = false;   // data service served cache-to-cache
+    uint16_t source_id  = 0;
+    uint64_t addr       = 0;
+    uint64_t issue_time = 0;
+    uint64_t delay      = 0;
+};
+
+class BusTraceWriter {
+public:
+    explicit BusTraceWriter(std::ostream& os);
+    void record(const BusReq& req);
+    uint64_t records() const { return num_records; }
+
+private:
+    std::ostream& os;
+    uint64_t prev_time   = 0;
+    uint64_t prev_addr   = 0;
+    uint64_t num_records = 0;
+
+    void put_varint(uint64_t value);
+};
+
+class BusTraceReader {
+public:
+    // throws std::runtime_error if the stream does not start with a bus trace header
+    explicit BusTraceReader(std::istream& is);
+    // returns false at end of trace
+    bool next(BusTraceRecord& rec);
+
+private:
+    std::istream& is;
+    uint64_t prev_time = 0;
+    uint64_t prev_addr = 0;
+
+    bool get_varint(uint64_t& value);
+};
+
+// -----------------------------------------------------
+//    BUS REPLAY                                       |
+// -----------------------------------------------------
+//  -- feeds a captured trace straight into a Bus (and its memory model),
+//     no caches involved; each request is re-issued at its captured time
+//  -- only the next batch of same-time records is ever scheduled, the
+//     trace is streamed
+class BusReplayer {
+public:
+    BusReplayer(EventSimulator& sim, Bus& bus, BusTraceReader& reader);
+    void start();
+    uint64_t replayed() const { return num_replayed; }
+
+private:
+    EventSimulator& sim;
+    Bus& bus;
+    BusTraceReader& reader;
+    BusTraceRecord pending;
+    bool has_pending = false;
+    uint64_t num_replayed = 0;
+
+    void issue_batch();
+};
@@ -4,31 +4,59 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <functional>
+#include <deque>
+#include <span>
 #include "EventSimulator.hpp"
 #include "Coherence.hpp"
 #include "Eviction.hpp"
 #include "Bus.hpp"
 #include "Logger.hpp"
+#include "Stats.hpp"
+#include "SimTask.hpp"
+#include "TagStore.hpp"
+#include "VictimCache.hpp"
 using namespace std;
 
 // -------------------- Base cache ----------------------
+// Completion callback of a read/write; invoked from inside the cache's own
+// completion event, so new accesses should be issued from a separately
+// scheduled event rather than synchronously from the callback.
+using Completion = std::function<void()>;
+
 class ICache {
 public:
     virtual bool snoop_read(uint64_t addr) = 0;
     virtual bool snoop_write(uint64_t addr) = 0;
-    virtual void rd_miss_callback(bool snoop_success, uint64_t addr) = 0;
-    virtual void wr_miss_callback(bool snoop_success, uint64_t addr) = 0;
-    virtual void read(uint64_t addr) = 0;
-    virtual void write(uint64_t addr) = 0;
+    virtual void read(uint64_t addr, Completion done = nullptr) = 0;
+    virtual void write(uint64_t addr, Completion done = nullptr) = 0;
     virtual std::string name() const = 0;
+    virtual void print_stats(std::ostream& os) const = 0;
     virtual ~ICache() = default;
 };
 
 // --------------------- MSHR ENTRY ---------------------
+struct MSHRWaiter {
+    uint64_t   issue_time = 0;
+    uint64_t   addr       = 0;
+    bool       is_write   = false;   // a store still needs write permission after the fill
+    Completion done;
+};
+
+// access that found every MSHR entry busy; restarted when an entry is freed 
+struct StalledAccess {
+    uint64_t   addr       = 0;
+    bool       is_write   = false;
+    uint64_t   issue_time = 0;
+    Completion done;
+};
+
 struct MSHREntry {
-    uint64_t blk_tag = 0;
-    bool     valid   = false;
-    // TDOD: waiters queue? 
+    uint64_t blk_tag    = 0;
+    bool     valid      = false;
+    uint64_t issue_time = 0;     // time at which the primary miss was issued
+    Completion done;             // completion of the primary miss
+    vector<MSHRWaiter> waiters;  // coalesced misses
 };
 
 struct MSHR {
@@ -41,29 +69,83 @@ struct MSHR {
             entry.valid   = false;
         }
     }
-    void allocate_mshr(uint64_t blk_tag){
+    // returns false if all entries are in use
+    bool allocate_mshr(uint64_t blk_tag, uint64_t issue_time, Completion done){
         for (auto& entry : table) {
             if (entry.valid == false) {
                 entry.valid = true;
                 entry.blk_tag = blk_tag;
-                break;
+                entry.issue_time = issue_time;
+                entry.done = std::move(done);
+                return true;
             }
         }
+        return false;
     }
     void deallocate_mshr(uint64_t blk_tag){
         for (auto& entry : table) {
-            if (entry.blk_tag == blk_tag) {
+            if (entry.blk_tag == blk_tag && entry.valid) {
                 entry.blk_tag = 0;
                 entry.valid = false;
+                entry.done = nullptr;
+                entry.waiters.clear();
                 break;
             }
         }
     }
-    bool is_mshr_present(uint64_t blk_tag){
+    bool has_free() const {
+        for (const auto& entry : table)
+            if (!entry.valid) return true;
+        return false;
+    }
+    MSHREntry* find_mshr(uint64_t blk_tag){
         for (auto& entry : table){
-            if (blk_tag == entry.blk_tag && entry.valid) return true;
+            if (blk_tag == entry.blk_tag && entry.valid) return &entry;
         }
-        return false;
+        return nullptr;
+    }
+    bool is_mshr_present(uint64_t blk_tag){
+        return find_mshr(blk_tag) != nullptr;
+    }
+};
+
+// -------------------- BANK PORTS ----------------------
+//  -- per bank, at most rd_ports reads and wr_ports writes start per cycle
+//  -- requests arrive in time order, so each port type keeps a booking
+//     cursor: the cycle of its last grant and how many ports that cycle used;
+//     a conflicting request is granted the first cycle with a free port
+struct BankPorts {
+    uint64_t rd_cycle = 0;
+    int      rd_used  = 0;
+    uint64_t wr_cycle = 0;
+    int      wr_used  = 0;
+};
+
+struct BankArray {
+    vector<BankPorts> banks;
+    int rd_ports   = 0;
+    int wr_ports   = 0;
+    int bank_shift = 0;
+
+    bool enabled() const { return !banks.empty(); }
+    size_t bank_of(uint64_t addr) const { return (addr >> bank_shift) % banks.size(); }
+
+    // cycle at which the access may start (>= now)
+    uint64_t reserve(uint64_t addr, bool is_write, uint64_t now){
+        auto& bank   = banks[bank_of(addr)];
+        uint64_t& cycle = is_write ? bank.wr_cycle : bank.rd_cycle;
+        int& used       = is_write ? bank.wr_used  : bank.rd_used;
+        int ports       = is_write ? wr_ports : rd_ports;
+        if (cycle < now) {
+            cycle = now;
+            used  = 0;
+        }
+        if (used == ports) {
+            cycle++;
+            used = 0;
+        }
+        used++;
+        return cycle;
     }
 };
 
@@ -78,12 +160,26 @@ struct Line {
 };
 
 // -------------------- Cache Set -----------------------
+//  -- 'ways' is a view of the set's lines: Set(assoc) owns them, Set(lines)
+//     uses lines that live elsewhere (carved from a TagStore slab)
 template <typename LineType, template <typename> class EvictionPolicy>
 struct Set {
-    vector<LineType> ways;
+    using WayType = LineType;
+
+    vector<LineType> own;        // empty when the lines are not owned
+    std::span<LineType> ways;
     EvictionPolicy<LineType> eviction;
 
-    Set(size_t assoc) : ways(assoc), eviction() {}
+    explicit Set(size_t assoc) : own(assoc), ways(own), eviction() {}
+    explicit Set(std::span<LineType> lines) : ways(lines), eviction() {}
+    // copies keep viewing their own lines
+    Set(const Set& other) : own(other.own), ways(own.empty() ? other.ways : std::span<LineType>(own)), eviction(other.eviction) {}
+    Set& operator=(const Set& other) {
+        own      = other.own;
+        ways     = own.empty() ? other.ways : std::span<LineType>(own);
+        eviction = other.eviction;
+        return *this;
+    }
 
     int choose_victim() { return eviction.choose_victim(ways); }
     void touch(int line_idx) { eviction.touch(line_idx); }
@@ -101,6 +197,7 @@ class Cache : public ICache {
 
     string cache_name;
     MSHR mshr;
+    std::deque<StalledAccess> mshr_stalled;  // structural stalls, oldest first
     // cache size parameters 
     size_t blk_size;
     size_t num_sets;
@@ -115,12 +212,16 @@ class Cache : public ICache {
     int snoop_lt;
     int snoop_hit_lt;
 
-    vector<SetType> sets;
+    TagStore<SetType> sets;
+    BankArray bank_array;  // disabled (unlimited ports) unless configure_banks() is called
+    VictimCache<typename CoherencePolicy::StateType> victim;  // disabled unless attach_victim_cache() is called
+    int victim_hit_lt = 0;
 
     EventSimulator& sim;  // cache pushes internal events to event_q
     Bus& bus;
     Logger& logger;
 
+    CacheStats stats;
 
     // addr bits 
     int blk_offset;
@@ -129,26 +230,41 @@ class Cache : public ICache {
 
 
 public:
-    Cache(string name, size_t blk_size, size_t num_sets, size_t assoc, size_t mm_size, int rd_hit_lt, int rd_miss_lt, int wr_hit_lt, int wr_miss_lt, int snoop_lt, int snoop_hit_lt, EventSimulator& sim, Bus& bus, Logger& logger);
+    Cache(string name, size_t blk_size, size_t num_sets, size_t assoc, size_t mm_size, int rd_hit_lt, int rd_miss_lt, int wr_hit_lt, int wr_miss_lt, int snoop_lt, int snoop_hit_lt, EventSimulator& sim, Bus& bus, Logger& logger, TagStoreMode tag_store = TagStoreMode::DENSE);
+
+    // Split the data array into 'num_banks' banks (selected by address bits from
+    // 'bank_shift' up; -1 --> block interleaved) with per-cycle port limits
+    void configure_banks(int num_banks, int rd_ports, int wr_ports, int bank_shift = -1);
+
+    // Fully associative victim buffer of 'entries' lines evicted from this cache,
+    // probed on a miss before going to the Bus; a hit costs 'hit_lt' and swaps lines
+    void attach_victim_cache(size_t entries, int hit_lt);
 
     // Main cache functions 
     LineType* find_line(uint64_t set_idx, uint64_t tag);
-    void read(uint64_t addr) override;
-    void write(uint64_t addr) override;
+    void read(uint64_t addr, Completion done = nullptr) override;
+    void write(uint64_t addr, Completion done = nullptr) override;
     bool snoop_read(uint64_t addr) override;
     bool snoop_write(uint64_t addr) override;
-    void rd_miss_callback(bool snoop_success, uint64_t addr) override;
-    void wr_miss_callback(bool snoop_success, uint64_t addr) override;
+    SimTask read_miss(uint64_t addr);
+    SimTask write_miss(uint64_t addr);
+    SimTask upgrade(uint64_t addr, uint64_t start, Completion done);
     std::string name() const override;
+    void print_stats(std::ostream& os) const override;
 
     // Helper functions 
     static size_t log2(size_t n);
     int index_in_set(SetType& set, LineType& line);
+    void complete_miss(uint64_t blk_addr);
+    void do_read(uint64_t addr, uint64_t start, Completion done);
+    void do_write(uint64_t addr, uint64_t start, Completion done);
+    LineType* allocate_line(uint64_t set_idx, uint64_t tag);
+    LineType* swap_from_victim(uint64_t set_idx, uint64_t tag);
 };
 
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
-Cache<CoherencePolicy, EvictionPolicy>::Cache(string name, size_t blk_size, size_t num_sets, size_t assoc, size_t mm_size, int rd_hit_lt, int rd_miss_lt, int wr_hit_lt, int wr_miss_lt, int snoop_lt, int snoop_hit_lt, EventSimulator& sim, Bus& bus, Logger& logger) 
-    : cache_name(std::move(name)), mshr(16), blk_size(blk_size), num_sets(num_sets), assoc(assoc), mm_size(mm_size), rd_hit_lt(rd_hit_lt), rd_miss_lt(rd_miss_lt), wr_hit_lt(wr_hit_lt), wr_miss_lt(wr_miss_lt), snoop_lt(snoop_lt), snoop_hit_lt(snoop_hit_lt), sets(num_sets, SetType(assoc)), sim(sim), bus(bus), logger(logger) {
+Cache<CoherencePolicy, EvictionPolicy>::Cache(string name, size_t blk_size, size_t num_sets, size_t assoc, size_t mm_size, int rd_hit_lt, int rd_miss_lt, int wr_hit_lt, int wr_miss_lt, int snoop_lt, int snoop_hit_lt, EventSimulator& sim, Bus& bus, Logger& logger, TagStoreMode tag_store) 
+    : cache_name(std::move(name)), mshr(16), blk_size(blk_size), num_sets(num_sets), assoc(assoc), mm_size(mm_size), rd_hit_lt(rd_hit_lt), rd_miss_lt(rd_miss_lt), wr_hit_lt(wr_hit_lt), wr_miss_lt(wr_miss_lt), snoop_lt(snoop_lt), snoop_hit_lt(snoop_hit_lt), sets(tag_store, num_sets, assoc), sim(sim), bus(bus), logger(logger) {
         blk_offset = log2(blk_size);
         set_bits   = log2(num_sets);
         tag_bits   = log2(mm_size) - (blk_offset + set_bits);
@@ -160,6 +276,27 @@ std::string Cache<CoherencePolicy, EvictionPolicy>::name() const {
     return cache_name;
 }
 
+template <typename CoherencePolicy, template <typename> class EvictionPolicy>
+void Cache<CoherencePolicy, EvictionPolicy>::configure_banks(int num_banks, int rd_ports, int wr_ports, int bank_shift){
+    bank_array.banks.assign(num_banks, BankPorts{});
+    bank_array.rd_ports   = rd_ports;
+    bank_array.wr_ports   = wr_ports;
+    bank_array.bank_shift = (bank_shift < 0) ? blk_offset : bank_shift;
+}
+
+template <typename CoherencePolicy, template <typename> class EvictionPolicy>
+void Cache<CoherencePolicy, EvictionPolicy>::attach_victim_cache(size_t entries, int hit_lt){
+    victim.configure(entries);
+    victim_hit_lt = hit_lt;
+}
+
+template <typename CoherencePolicy, template <typename> class EvictionPolicy>
+void Cache<CoherencePolicy, EvictionPolicy>::print_stats(std::ostream& os) const {
+    stats.print(os, cache_name);
+    os << "  sets materialized " << sets.materialized() << " / " << sets.size() << "\n";
+    if (victim.enabled()) victim.print_stats(os);
+}
+
 // Cache will have following functions:
 //  -- 1. find_line()
 //  -- 2. read()
@@ -172,9 +309,12 @@ std::string Cache<CoherencePolicy, EvictionPolicy>::name() const {
 // -------------------------------------------------------
 //      -- Used to see if a cache block is present or not 
 //      -- Returns line if found, else nullptr 
+//      -- Never materializes a set (an untouched set holds no lines) 
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
 typename Cache<CoherencePolicy, EvictionPolicy>::LineType* Cache<CoherencePolicy, EvictionPolicy>::find_line(uint64_t set_idx, uint64_t tag){
-    for (auto &line : sets[set_idx].ways){
+    auto* set = sets.peek(set_idx);
+    if (!set) return nullptr;
+    for (auto &line : set->ways){
         if(line.valid && line.tag == tag)
             return &line;
     }
@@ -187,12 +327,32 @@ typename Cache<CoherencePolicy, EvictionPolicy>::LineType* Cache<CoherencePolicy
 //      -- cache.read(addr) is put into Event as 'action' from top 
 //      -- time send along with read into the event is time at which read req is made 
 //      -- Once 'read' is processed in event_q, schedule 'Hit' or 'Miss' 
+//      -- 'done' is invoked once the line is returned (hit, miss or coalesced miss) 
+//      -- with banking, a read that finds no free read port in its bank waits for one 
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
-void Cache<CoherencePolicy, EvictionPolicy>::read(uint64_t addr){
-    uint64_t set_idx = (addr >> blk_offset) & ((1 << set_bits) - 1);
-    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1 << tag_bits) - 1); 
+void Cache<CoherencePolicy, EvictionPolicy>::read(uint64_t addr, Completion done){
+    uint64_t start = sim.now();
+    if (bank_array.enabled()) {
+        uint64_t grant = bank_array.reserve(addr, false, start);
+        if (grant > start) {
+            logger.log(sim.now(), "Cache_" + cache_name + " :: READ_REQUEST for addr(" + to_string(addr) + ") --> BANK_CONFLICT on BANK[" 
+                                  + to_string(bank_array.bank_of(addr)) + "], delayed to @" + to_string(grant));
+            stats.bank_stall.record(grant - start);
+            sim.schedule(grant, [this, addr, start, done = std::move(done)]() mutable {
+                do_read(addr, start, std::move(done));
+            });
+            return;
+        }
+    }
+    do_read(addr, start, std::move(done));
+}
+
+template<typename CoherencePolicy, template <typename> class EvictionPolicy>
+void Cache<CoherencePolicy, EvictionPolicy>::do_read(uint64_t addr, uint64_t start, Completion done){
+    uint64_t set_idx  = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag      = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
+    uint64_t blk_addr = addr >> blk_offset;
 
-    auto& set  = sets[set_idx];
     auto* line = find_line(set_idx, tag);
     logger.log(sim.now(), "Cache_" + cache_name + " :: READ_REQUEST for addr(" + to_string(addr) + 
                           ") --> on SET[" + to_string(set_idx) + "] with TAG[" + to_string(tag) + "]");
@@ -200,132 +360,221 @@ void Cache<CoherencePolicy, EvictionPolicy>::read(uint64_t addr){
     // ----------------- READ HIT --------------- 
     if (line && coherence.can_read(line->coherence_state)){
         logger.log(sim.now(), "Cache_" + cache_name + " ::  --> READ_HIT for addr(" + to_string(addr) + ")");
-        sim.schedule(sim.now() + rd_hit_lt, [this, &set, line, addr]() mutable {
-            set.touch(index_in_set(set, *line));
+        sim.schedule(sim.now() + rd_hit_lt, [this, set_idx, tag, addr, start, done = std::move(done)]() mutable {
+            // the way may have been refilled meanwhile --> only touch it if it still holds the block 
+            if (auto* hit_line = find_line(set_idx, tag)) {
+                auto& set = sets.at(set_idx);
+                set.touch(index_in_set(set, *hit_line));
+            }
+            stats.hit.record(sim.now() - start);
             logger.log(sim.now(), "Cache_" + cache_name + " :: LINE RETURNED for addr(" + to_string(addr) + ")");
+            if (done) done();
             });
     }
     // ----------------- READ MISS -------------- 
     else {
         logger.log(sim.now(), "Cache_" + cache_name + " ::  --> READ_MISS for addr(" + to_string(addr) + ")");
         // if MSHR entry already present, merge miss, no need to schedule another miss 
-        if (mshr.is_mshr_present(tag)) {
+        if (auto* entry = mshr.find_mshr(blk_addr)) {
             logger.log(sim.now(), "Cache_" + cache_name + " ::  --> READ_MISS for addr(" + to_string(addr) + ") exists in MSHR --> COALESCED");
+            entry->waiters.push_back(MSHRWaiter{start, addr, false, std::move(done)});
+            return;
+        }
+
+        // probe the victim cache before going to the bus; a hit swaps the line back in 
+        if (swap_from_victim(set_idx, tag)) {
+            logger.log(sim.now(), "Cache_" + cache_name + " ::  --> READ_MISS for addr(" + to_string(addr) + ") --> VICTIM_HIT");
+            sim.schedule(sim.now() + victim_hit_lt, [this, addr, start, done = std::move(done)]() mutable {
+                stats.victim_hit.record(sim.now() - start);
+                logger.log(sim.now(), "Cache_" + cache_name + " :: LINE RETURNED for addr(" + to_string(addr) + ")");
+                if (done) done();
+            });
             return;
         }
 
         // if MSHR entry not present, create new miss and new MSHR entry 
-        mshr.allocate_mshr(tag);
-        //bus.broadcast_snoop(this, false, true, addr, snoop_lt);
-
-        // request bus_grant for a snoop broadcast 
-        BusReq req(BusReqType::SNOOP_READ, this, addr, snoop_lt); 
-        req.callback = [this, addr](bool snoop_success){
-            this->rd_miss_callback(snoop_success, addr);
-        };
-        bus.request_grant(req);
+        // (all MSHRs busy --> structural stall until complete_miss frees an entry)
+        if (!mshr.allocate_mshr(blk_addr, start, done)) {
+            logger.log(sim.now(), "Cache_" + cache_name + " ::  --> READ_MISS for addr(" + to_string(addr) + ") MSHR FULL --> STALLED");
+            mshr_stalled.push_back(StalledAccess{addr, false, start, std::move(done)});
+            return;
+        }
+        read_miss(addr);
     }
 
 }
 
+// Read miss transaction: snoop broadcast --> data service --> fill 
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
-void Cache<CoherencePolicy, EvictionPolicy>::rd_miss_callback(bool snoop_success, uint64_t addr){
-    uint64_t set_idx = (addr >> blk_offset) & ((1 << set_bits) - 1);
-    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1 << tag_bits) - 1); 
-
-    //auto* line = find_line(set_idx, tag);
-    int miss_latency = ((snoop_success == true) ? snoop_hit_lt : rd_miss_lt);
-
-    BusReq req(BusReqType::READ_MISS_SERVICE, this, addr, miss_latency);
-    req.callback = [this, set_idx, tag, addr](int success){   // success is always true 
-        auto& set = sets[set_idx];
-        int victim_idx = set.choose_victim();
-        auto* line = &set.ways[victim_idx];
-        line->valid = true;
-        line->tag   = tag; 
-        coherence.on_read_miss(line->coherence_state);
-        set.touch(victim_idx);
-        logger.log(sim.now(), "Cache_" + cache_name + " :: LINE RETURNED for addr(" + to_string(addr) + ")");
-        mshr.deallocate_mshr(tag);
-    };
-    bus.request_grant(req);
+SimTask Cache<CoherencePolicy, EvictionPolicy>::read_miss(uint64_t addr){
+    uint64_t set_idx = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
+
+    // request bus_grant for a snoop broadcast 
+    bool snoop_success = co_await bus.grant(BusReq(BusReqType::SNOOP_READ, this, addr, snoop_lt));
+    int miss_latency   = ((snoop_success == true) ? snoop_hit_lt : rd_miss_lt);
+
+    BusReq service(BusReqType::READ_MISS_SERVICE, this, addr, miss_latency);
+    service.c2c = snoop_success;
+    co_await bus.grant(std::move(service)); // success is always true 
+
+    auto* line = allocate_line(set_idx, tag);
+    coherence.on_read_miss(line->coherence_state);
+    logger.log(sim.now(), "Cache_" + cache_name + " :: LINE RETURNED for addr(" + to_string(addr) + ")");
+    complete_miss(addr >> blk_offset);
 }
 
 // -------------------------------------------------------
 // 3, cache.write()                                      | 
 // -------------------------------------------------------
+//      -- 'done' is invoked once the line is written (hit, upgrade, miss or coalesced miss) 
+//      -- with banking, a write that finds no free write port in its bank waits for one 
+template<typename CoherencePolicy, template <typename> class EvictionPolicy>
+void Cache<CoherencePolicy, EvictionPolicy>::write(uint64_t addr, Completion done){
+    uint64_t start = sim.now();
+    if (bank_array.enabled()) {
+        uint64_t grant = bank_array.reserve(addr, true, start);
+        if (grant > start) {
+            logger.log(sim.now(), "Cache_" + cache_name + " :: WRITE_REQUEST for addr(" + to_string(addr) + ") --> BANK_CONFLICT on BANK[" 
+                                  + to_string(bank_array.bank_of(addr)) + "], delayed to @" + to_string(grant));
+            stats.bank_stall.record(grant - start);
+            sim.schedule(grant, [this, addr, start, done = std::move(done)]() mutable {
+                do_write(addr, start, std::move(done));
+            });
+            return;
+        }
+    }
+    do_write(addr, start, std::move(done));
+}
+
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
-void Cache<CoherencePolicy, EvictionPolicy>::write(uint64_t addr){
-    uint64_t set_idx = (addr >> blk_offset) & ((1 << set_bits) - 1);
-    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1 << tag_bits) - 1); 
+void Cache<CoherencePolicy, EvictionPolicy>::do_write(uint64_t addr, uint64_t start, Completion done){
+    uint64_t set_idx  = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag      = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
+    uint64_t blk_addr = addr >> blk_offset;
 
-    auto& set  = sets[set_idx];
     auto* line = find_line(set_idx, tag);
     logger.log(sim.now(), "Cache_" + cache_name + " :: WRITE_REQUEST for addr(" + to_string(addr) + 
                           ") --> on SET[" + to_string(set_idx) + "] with TAG[" + to_string(tag) + "]");
 
     // ----------------- WRITE HIT --------------- 
-    if (line){
+    // (an invalidated copy in I is a miss, as in do_read) 
+    if (line && coherence.can_read(line->coherence_state)){
         logger.log(sim.now(), "Cache_" + cache_name + " ::  --> WRITE_HIT for addr(" + to_string(addr) + ")");
-        if (coherence.can_write(line->coherence_state)){ // Line is in I, M or E state
-            sim.schedule(sim.now() + wr_hit_lt, [this, &set, line, addr]() mutable {
-                set.touch(index_in_set(set, *line));
-                coherence.on_write(line->coherence_state); // changes to M
+        if (coherence.can_write(line->coherence_state)){ // Line is in M or E state
+            sim.schedule(sim.now() + wr_hit_lt, [this, set_idx, tag, addr, start, done = std::move(done)]() mutable {
+                // look the line up again: a fill or another cache's snoop may have taken it meanwhile 
+                auto* hit_line = find_line(set_idx, tag);
+                if (!hit_line || !coherence.can_read(hit_line->coherence_state)) {  // gone or I --> write miss 
+                    logger.log(sim.now(), "Cache_" + cache_name + " :: WRITE_HIT for addr(" + to_string(addr) + ") lost the line --> RETRY");
+                    do_write(addr, start, std::move(done));
+                    return;
+                }
+                if (!coherence.can_write(hit_line->coherence_state)) {  // downgraded to S by a snoop_read 
+                    upgrade(addr, start, std::move(done));
+                    return;
+                }
+                auto& set = sets.at(set_idx);
+                set.touch(index_in_set(set, *hit_line));
+                std::string old_state = coherence.state_to_string(hit_line->coherence_state);
+                coherence.on_write(hit_line->coherence_state); // changes to M
+                stats.hit.record(sim.now() - start);
                 logger.log(sim.now(), "Cache_" + cache_name + " :: LINE WRITTEN for addr(" + to_string(addr) 
-                           + ") -- (state:" + coherence.state_to_string(line->coherence_state) + " --> M)");
+                           + ") -- (state:" + old_state + " --> M)");
+                if (done) done();
                 });
         } 
         else{  // Line is in S state
-            //bus.broadcast_snoop(this, true, false, addr, snoop_lt); // broadcast Invalidate to other sharers
-            BusReq req(BusReqType::INVALIDATE, this, addr, snoop_lt);
-            req.callback = [this, &set, line, addr](bool snoop_success) {
-                sim.schedule(sim.now() + wr_hit_lt, [this, &set, line, addr]() mutable {
-                    set.touch(index_in_set(set, *line));
-                    coherence.on_write(line->coherence_state); // changes to M
-                    logger.log(sim.now(), "Cache_" + cache_name + " :: LINE WRITTEN for addr(" + to_string(addr) + ") -- (state:S --> M)");
-                });
-            };
+            upgrade(addr, start, std::move(done));
         }
     }
     // ----------------- WRITE MISS --------------- 
     else {
         logger.log(sim.now(), "Cache_" + cache_name + " ::  --> WRITE_MISS for addr(" + to_string(addr) + ")");
         // if MSHR entry already present, merge miss, no need to schedule another miss 
-        if (mshr.is_mshr_present(tag)){ 
+        if (auto* entry = mshr.find_mshr(blk_addr)){ 
             logger.log(sim.now(), "Cache_" + cache_name + " ::  --> WRITE_MISS for addr(" + to_string(addr) + ") exists in MSHR --> COALESCED");
+            entry->waiters.push_back(MSHRWaiter{start, addr, true, std::move(done)});
+            return;
+        }
+
+        // probe the victim cache before going to the bus; a hit swaps the line back in 
+        // (the swap costs victim_hit_lt for every store; an S line then still needs an upgrade, 
+        //  which records the store's latency as 'upgrade' instead of 'victim_hit') 
+        if (swap_from_victim(set_idx, tag)) {
+            logger.log(sim.now(), "Cache_" + cache_name + " ::  --> WRITE_MISS for addr(" + to_string(addr) + ") --> VICTIM_HIT");
+            sim.schedule(sim.now() + victim_hit_lt, [this, set_idx, tag, addr, start, done = std::move(done)]() mutable {
+                auto* line = find_line(set_idx, tag);
+                if (!line || !coherence.can_read(line->coherence_state)) {  // lost during the swap 
+                    do_write(addr, start, std::move(done));
+                    return;
+                }
+                if (!coherence.can_write(line->coherence_state)) {  // S line --> needs an upgrade 
+                    upgrade(addr, start, std::move(done));
+                    return;
+                }
+                coherence.on_write(line->coherence_state); // changes to M
+                stats.victim_hit.record(sim.now() - start);
+                logger.log(sim.now(), "Cache_" + cache_name + " :: LINE WRITTEN for addr(" + to_string(addr) + ") -- (victim --> M)");
+                if (done) done();
+            });
             return;
         }
 
         // if MSHR entry not present, create new miss and new MSHR entry 
-        mshr.allocate_mshr(tag);
-        //bus.broadcast_snoop(this, true, true, addr, snoop_lt); // broadcast Invalidate to other sharers
-        BusReq req(BusReqType::SNOOP_WRITE, this, addr, snoop_lt);
-        req.callback = [this, addr](bool snoop_success){
-            this->wr_miss_callback(snoop_success, addr);
-        };
-        bus.request_grant(req);
+        // (all MSHRs busy --> structural stall until complete_miss frees an entry)
+        if (!mshr.allocate_mshr(blk_addr, start, done)) {
+            logger.log(sim.now(), "Cache_" + cache_name + " ::  --> WRITE_MISS for addr(" + to_string(addr) + ") MSHR FULL --> STALLED");
+            mshr_stalled.push_back(StalledAccess{addr, true, start, std::move(done)});
+            return;
+        }
+        write_miss(addr);
+    }
+}
+
+// Write upgrade transaction (S --> M): invalidate other sharers --> write 
+//      -- the way is looked up again once the bus was granted: while waiting the line may 
+//         have been evicted by a fill or invalidated by another cache's SNOOP_WRITE, 
+//         then the store restarts as a write miss 
+template<typename CoherencePolicy, template <typename> class EvictionPolicy>
+SimTask Cache<CoherencePolicy, EvictionPolicy>::upgrade(uint64_t addr, uint64_t start, Completion done){
+    uint64_t set_idx = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
+
+    co_await bus.grant(BusReq(BusReqType::INVALIDATE, this, addr, snoop_lt));
+    co_await sim.delay(wr_hit_lt);
+
+    auto* line = find_line(set_idx, tag);
+    if (!line || !coherence.can_read(line->coherence_state)) {
+        logger.log(sim.now(), "Cache_" + cache_name + " :: UPGRADE for addr(" + to_string(addr) + ") lost the line --> WRITE_MISS");
+        do_write(addr, start, std::move(done));
+        co_return;
     }
+    auto& set = sets.at(set_idx);
+    set.touch(index_in_set(set, *line));
+    coherence.on_write(line->coherence_state); // changes to M
+    stats.upgrade.record(sim.now() - start);
+    logger.log(sim.now(), "Cache_" + cache_name + " :: LINE WRITTEN for addr(" + to_string(addr) + ") -- (state:S --> M)");
+    if (done) done();
 }
+
+// Write miss transaction: snoop broadcast (invalidating) --> data service --> fill in M 
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
-void Cache<CoherencePolicy, EvictionPolicy>::wr_miss_callback(bool snoop_success, uint64_t addr){
-    uint64_t set_idx = (addr >> blk_offset) & ((1 << set_bits) - 1);
-    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1 << tag_bits) - 1); 
-
-    //auto* line = find_line(set_idx, tag);
-    int miss_latency = ((snoop_success == true) ? snoop_hit_lt : wr_miss_lt);
-
-    BusReq req(BusReqType::WRITE_MISS_SERVICE, this, addr, miss_latency);
-    req.callback = [this, set_idx, tag, addr](bool success){
-        auto& set = sets[set_idx];
-        int victim_idx = set.choose_victim();
-        auto* line = &set.ways[victim_idx];
-        line->valid = true;
-        line->tag = tag; 
-        coherence.on_write(line->coherence_state); // changes to M
-        logger.log(sim.now(), "Cache_" + cache_name + " :: LINE WRITTEN for addr(" + to_string(addr) + ") -- (state:I --> M)");
-        mshr.deallocate_mshr(tag);
-    };
-    bus.request_grant(req);
+SimTask Cache<CoherencePolicy, EvictionPolicy>::write_miss(uint64_t addr){
+    uint64_t set_idx = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
+
+    bool snoop_success = co_await bus.grant(BusReq(BusReqType::SNOOP_WRITE, this, addr, snoop_lt));
+    int miss_latency   = ((snoop_success == true) ? snoop_hit_lt : wr_miss_lt);
+
+    BusReq service(BusReqType::WRITE_MISS_SERVICE, this, addr, miss_latency);
+    service.c2c = snoop_success;
+    co_await bus.grant(std::move(service));
+
+    auto* line = allocate_line(set_idx, tag);
+    coherence.on_write(line->coherence_state); // changes to M
+    logger.log(sim.now(), "Cache_" + cache_name + " :: LINE WRITTEN for addr(" + to_string(addr) + ") -- (state:I --> M)");
+    complete_miss(addr >> blk_offset);
 }
 
 // -------------------------------------------------------
@@ -333,14 +582,20 @@ void Cache<CoherencePolicy, EvictionPolicy>::wr_miss_callback(bool snoop_success
 // -------------------------------------------------------
 template<typename CoherencePolicy, template <typename> class EvictionPolicy>
 bool Cache<CoherencePolicy, EvictionPolicy>::snoop_read(uint64_t addr){
-    uint64_t set_idx = (addr >> blk_offset) & ((1 << set_bits) - 1);
-    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1 << tag_bits) - 1); 
+    uint64_t set_idx = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
     //auto& set        = sets[set_idx];
     auto* line       = find_line(set_idx, tag);
     if(line){
         coherence.on_snoop_read(line->coherence_state);
         return true;
     }
+    // line may sit in the victim cache 
+    if (auto* ventry = victim.find(addr >> blk_offset)) {
+        coherence.on_snoop_read(ventry->state);
+        victim.stats.snoop_hits++;
+        return true;
+    }
     return false;
 }
 
@@ -349,14 +604,20 @@ bool Cache<CoherencePolicy, EvictionPolicy>::snoop_read(uint64_t addr){
 // -------------------------------------------------------
 template <typename CoherencePolicy, template <typename> class EvictionPolicy>
 bool Cache<CoherencePolicy, EvictionPolicy>::snoop_write(uint64_t addr){
-    uint64_t set_idx = (addr >> blk_offset) & ((1 << set_bits) - 1);
-    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1 << tag_bits) - 1); 
+    uint64_t set_idx = (addr >> blk_offset) & ((1ULL << set_bits) - 1);
+    uint64_t tag     = (addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1); 
     //auto& set        = sets[set_idx];
     auto* line       = find_line(set_idx, tag);
     if(line){
         coherence.on_snoop_write(line->coherence_state);
         return true;
     }
+    // a victim cache copy is dropped (it would only hold state I) 
+    if (victim.find(addr >> blk_offset)) {
+        victim.stats.snoop_hits++;
+        victim.invalidate(addr >> blk_offset);
+        return true;
+    }
     return false;
 }
 
@@ -372,3 +633,76 @@ int Cache<CoherencePolicy, EvictionPolicy>::index_in_set(SetType& set, LineType&
     return &line - &set.ways[0];
 }
 
+// Way for a newly filled 'tag' in 'set_idx' 
+//      -- a stale (invalidated) copy of the same tag is refilled in place 
+//      -- otherwise a victim is evicted; a valid victim goes to the victim cache (if attached) 
+//      -- the line comes back valid, tagged, touched and in the default coherence state 
+template<typename CoherencePolicy, template <typename> class EvictionPolicy>
+typename Cache<CoherencePolicy, EvictionPolicy>::LineType* Cache<CoherencePolicy, EvictionPolicy>::allocate_line(uint64_t set_idx, uint64_t tag){
+    auto& set   = sets.at(set_idx);
+    auto* stale = find_line(set_idx, tag);
+    int way     = stale ? index_in_set(set, *stale) : set.choose_victim();
+    auto* line  = &set.ways[way];
+
+    if (!stale && line->valid && victim.enabled() && coherence.can_read(line->coherence_state))
+        victim.insert((line->tag << set_bits) | set_idx, line->coherence_state);
+
+    line->valid = true;
+    line->tag   = tag;
+    line->coherence_state = CoherencePolicy::default_state();
+    set.touch(way);
+    return line;
+}
+
+// Victim cache probe on a miss: on hit the line is swapped into the set
+// (with its coherence state) and returned, else nullptr 
+template<typename CoherencePolicy, template <typename> class EvictionPolicy>
+typename Cache<CoherencePolicy, EvictionPolicy>::LineType* Cache<CoherencePolicy, EvictionPolicy>::swap_from_victim(uint64_t set_idx, uint64_t tag){
+    if (!victim.enabled()) return nullptr;
+    typename CoherencePolicy::StateType state;
+    if (!victim.extract((tag << set_bits) | set_idx, state)) return nullptr;
+    auto* line = allocate_line(set_idx, tag);
+    line->coherence_state = state;
+    return line;
+}
+
+// Frees the MSHR entry, then records latency of the primary miss and every coalesced waiter and notifies them 
+//      -- the entry is emptied before any callback runs, so a 'done' that issues a new access 
+//         to the same block starts a fresh miss instead of joining a dead entry 
+//      -- a coalesced store on a line filled without write permission (read miss --> S) 
+//         goes back through do_write and upgrades like any write hit on S 
+//      -- accesses stalled on a full MSHR restart (oldest first) while entries are free 
+template<typename CoherencePolicy, template <typename> class EvictionPolicy>
+void Cache<CoherencePolicy, EvictionPolicy>::complete_miss(uint64_t blk_addr){
+    auto* entry = mshr.find_mshr(blk_addr);
+    if (!entry) return;
+    uint64_t issue_time = entry->issue_time;
+    Completion done     = std::move(entry->done);
+    auto waiters        = std::move(entry->waiters);
+    mshr.deallocate_mshr(blk_addr);
+
+    stats.miss.record(sim.now() - issue_time);
+    if (done) done();
+    for (auto& waiter : waiters) {
+        uint64_t set_idx = (waiter.addr >> blk_offset) & ((1ULL << set_bits) - 1);
+        uint64_t tag     = (waiter.addr >> (blk_offset + set_bits)) & ((1ULL << tag_bits) - 1);
+        auto* line       = find_line(set_idx, tag);
+        bool writable    = line && coherence.can_read(line->coherence_state) && coherence.can_write(line->coherence_state);
+        if (waiter.is_write && !writable) {
+            logger.log(sim.now(), "Cache_" + cache_name + " :: COALESCED WRITE for addr(" + to_string(waiter.addr) + ") needs write permission --> RETRY");
+            do_write(waiter.addr, waiter.issue_time, std::move(waiter.done));
+            continue;
+        }
+        if (waiter.is_write) coherence.on_write(line->coherence_state); // changes to M
+        stats.coalesced.record(sim.now() - waiter.issue_time);
+        if (waiter.done) waiter.done();
+    }
+
+    while (!mshr_stalled.empty() && mshr.has_free()) {
+        StalledAccess stalled = std::move(mshr_stalled.front());
+        mshr_stalled.pop_front();
+        if (stalled.is_write) do_write(stalled.addr, stalled.issue_time, std::move(stalled.done));
+        else                  do_read(stalled.addr, stalled.issue_time, std::move(stalled.done));
+    }
+}
+
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "EventSimulator.hpp"
+#include "Workload.hpp"
+
+class ICache; // forward declaration
+
+// -----------------------------------------------------
+//    CLOSED LOOP CORE                                 |
+// -----------------------------------------------------
+//  -- drives one ICache from one workload stream
+//  -- at most 'max_outstanding' loads/stores in flight (instruction window),
+//     at most 'issue_width' new accesses per cycle
+//  -- a full window stalls issue until a completion callback frees a slot,
+//     so throughput reflects miss latency and memory-level parallelism
+class Core {
+public:
+    Core(std::string name, EventSimulator& sim, ICache& cache, IWorkload& workload,
+         int max_outstanding, int issue_width = 1);
+
+    // schedule the first issue cycle at 'start_time'
+    void start(uint64_t start_time);
+
+    uint64_t issued() const { return num_issued; }
+    uint64_t completed() const { return num_completed; }
+    uint64_t cycles() const { return last_completion - start_cycle; }
+    double   accesses_per_cycle() const { return cycles() ? double(num_completed) / double(cycles()) : 0.0; }
+
+    void print_stats(std::ostream& os) const;
+
+private:
+    std::string core_name;
+    EventSimulator& sim;
+    ICache& cache;
+    IWorkload& workload;
+    int max_outstanding;
+    int issue_width;
+
+    int      outstanding       = 0;
+    bool     stream_done       = false;
+    bool     issue_scheduled   = false;
+    uint64_t issue_cycle       = 0;   // cycle of the current issue slot
+    int      issued_this_cycle = 0;
+
+    uint64_t start_cycle     = 0;
+    uint64_t last_completion = 0;
+    uint64_t num_issued      = 0;
+    uint64_t num_completed   = 0;
+    uint64_t full_since      = 0;     // cycle at which the window filled up
+    uint64_t stall_cycles    = 0;     // cycles spent with a full window
+
+    void schedule_issue(uint64_t time);
+    void try_issue();
+    void on_complete();
+};
@@ -1,22 +1,40 @@
 #pragma once
+#include <coroutine>
 #include <functional>
 #include <queue>
 #include <vector>
 #include <cstdint>
 
+// Events at the same time run in the order they were scheduled (seq breaks ties)
 struct Event {
     uint64_t time;
+    uint64_t seq;
     std::function<void()> action;
-    bool operator<(const Event& other) const { return time > other.time; }
+    bool operator<(const Event& other) const {
+        return time != other.time ? time > other.time : seq > other.seq;
+    }
 };
 
 
 class EventSimulator {
     uint64_t currentTime = 0;
+    uint64_t next_seq = 0;
     std::priority_queue<Event> event_q; 
 public:
     void schedule(uint64_t time, std::function<void()> action);
     void run_sim();
     uint64_t now();
+
+    // co_await sim.delay(n) --> resumes the awaiting coroutine n cycles from now
+    struct DelayAwaiter {
+        EventSimulator& sim;
+        uint64_t cycles;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            sim.schedule(sim.now() + cycles, [h](){ h.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    DelayAwaiter delay(uint64_t cycles) { return DelayAwaiter{*this, cycles}; }
 };
 
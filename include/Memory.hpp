@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct BusReq; // forward declaration
+
+// -----------------------------------------------------
+//    MEMORY MODELS                                    |
+// -----------------------------------------------------
+//  -- consulted by the Bus for data services that are not served
+//     cache-to-cache; returns the service latency of the request
+//  -- without a memory model the Bus uses the latency carried in the request
+struct IMemory {
+    virtual uint64_t access(const BusReq& req, uint64_t now) = 0;
+    virtual ~IMemory() = default;
+};
+
+// Every access takes the same time
+struct FixedLatencyMemory : IMemory {
+    uint64_t latency;
+    explicit FixedLatencyMemory(uint64_t latency) : latency(latency) {}
+    uint64_t access(const BusReq& req, uint64_t now) override { return latency; }
+};
+
+// Interleaved banks with one open row each
+//  -- bank = block index % num_banks, row = address / row_size
+//  -- open row hit costs 'row_hit_lt', otherwise 'row_miss_lt'
+//  -- a busy bank delays the access until it is free
+class BankedMemory : public IMemory {
+public:
+    BankedMemory(int num_banks, uint64_t blk_size, uint64_t row_size, uint64_t row_hit_lt, uint64_t row_miss_lt);
+    uint64_t access(const BusReq& req, uint64_t now) override;
+
+    uint64_t row_hits() const { return num_row_hits; }
+    uint64_t row_misses() const { return num_row_misses; }
+
+private:
+    struct Bank {
+        uint64_t busy_until = 0;
+        uint64_t open_row   = 0;
+        bool     row_valid  = false;
+    };
+    std::vector<Bank> banks;
+    uint64_t blk_size, row_size, row_hit_lt, row_miss_lt;
+    uint64_t num_row_hits   = 0;
+    uint64_t num_row_misses = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+// -----------------------------------------------------
+//    COROUTINE FRAME POOL                             |
+// -----------------------------------------------------
+//  -- size-class free lists (64 byte granules, up to 1 KiB) for coroutine frames
+//  -- freed frames are kept for reuse, so a steady stream of transactions
+//     stops hitting the heap once the pool is warm
+//  -- larger frames fall back to ::operator new
+//  -- single threaded, like the rest of the simulator
+class FramePool {
+public:
+    static void* allocate(std::size_t size);
+    static void  deallocate(void* ptr, std::size_t size);
+
+private:
+    static constexpr std::size_t GRANULE     = 64;
+    static constexpr std::size_t NUM_CLASSES = 16;
+    static constexpr std::size_t SLAB_FRAMES = 32;   // frames carved per refill
+
+    struct FreeNode { FreeNode* next; };
+    static inline FreeNode* free_list[NUM_CLASSES] = {};
+
+    static std::size_t size_class(std::size_t size) { return (size + GRANULE - 1) / GRANULE - 1; }
+    static void refill(std::size_t cls);
+};
+
+// -----------------------------------------------------
+//    SIM TASK                                         |
+// -----------------------------------------------------
+//  -- fire-and-forget coroutine for one transaction (e.g. a cache miss)
+//  -- starts running immediately, suspends on co_await sim.delay(n) or
+//     co_await bus.grant(req), and frees its frame when it returns
+struct SimTask {
+    struct promise_type {
+        SimTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        static void* operator new(std::size_t size) { return FramePool::allocate(size); }
+        static void  operator delete(void* ptr, std::size_t size) { FramePool::deallocate(ptr, size); }
+    };
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// -----------------------------------------------------
+//    LATENCY HISTOGRAM                                |
+// -----------------------------------------------------
+//  -- HDR-style log-linear histogram with fixed memory
+//  -- values below 2^SUB_BITS are counted exactly, larger values land in
+//     one of 2^SUB_BITS linear sub-buckets of their power-of-two range
+//     (relative error <= 1 / 2^SUB_BITS)
+//  -- record() is O(1) and never allocates
+class LatencyHistogram {
+public:
+    static constexpr int      SUB_BITS    = 5;
+    static constexpr uint64_t SUB_COUNT   = 1ULL << SUB_BITS;
+    static constexpr size_t   NUM_BUCKETS = SUB_COUNT * (64 - SUB_BITS + 1);
+
+    void record(uint64_t value) {
+        counts[bucket_index(value)]++;
+        total++;
+        sum += value;
+        if (value < min_value) min_value = value;
+        if (value > max_value) max_value = value;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double   mean() const { return total ? double(sum) / double(total) : 0.0; }
+
+    // Value at or below which 'pct' percent of the samples fall
+    // (reported as the upper edge of the matching bucket, clamped to max)
+    uint64_t percentile(double pct) const;
+
+    // Pretty printing for end of simulation reports
+    static void print_header(std::ostream& os);
+    void print_row(std::ostream& os, const std::string& label) const;
+
+private:
+    std::array<uint64_t, NUM_BUCKETS> counts{};
+    uint64_t total     = 0;
+    uint64_t sum       = 0;
+    uint64_t min_value = UINT64_MAX;
+    uint64_t max_value = 0;
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < SUB_COUNT) return value;
+        int msb   = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BITS;
+        return SUB_COUNT * (shift + 1) + ((value >> shift) - SUB_COUNT);
+    }
+    static uint64_t bucket_upper(size_t idx) {
+        if (idx < SUB_COUNT) return idx;
+        int      shift = int(idx / SUB_COUNT) - 1;
+        uint64_t sub   = idx % SUB_COUNT;
+        return ((SUB_COUNT + sub) << shift) + ((1ULL << shift) - 1);
+    }
+};
+
+// -----------------------------------------------------
+//    PER CACHE LATENCY STATS                          |
+// -----------------------------------------------------
+//  -- every access is timestamped at read()/write() entry and recorded
+//     into exactly one class when it completes
+struct CacheStats {
+    LatencyHistogram hit;        // read/write hits
+    LatencyHistogram miss;       // primary misses (own an MSHR entry)
+    LatencyHistogram coalesced;  // misses merged into an in-flight MSHR entry
+    LatencyHistogram upgrade;    // write hits on S lines (S --> M invalidate)
+    LatencyHistogram victim_hit; // misses served by the victim cache
+    LatencyHistogram bank_stall; // wait for a bank port (one sample per bank conflict)
+
+    void print(std::ostream& os, const std::string& name) const;
+};
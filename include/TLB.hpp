@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Cache.hpp"
+#include "EventSimulator.hpp"
+#include "Eviction.hpp"
+#include "Logger.hpp"
+#include "SimTask.hpp"
+#include "Stats.hpp"
+
+// -----------------------------------------------------
+//    TLB + PAGE WALK                                  |
+// -----------------------------------------------------
+//  -- sits in front of an ICache and implements ICache itself, so a Core
+//     (or a WorkloadDriver) can drive a TLB exactly like a cache
+//  -- one set associative array (LRU) per page size: 4K, 2M and 1G; the page
+//     size of an address comes from the region map (map_region), anything
+//     outside every region uses the default page size given at construction
+//  -- the arrays are probed in parallel in hardware; since an address has a
+//     single page size, the model only looks in the array of that size
+//  -- a miss walks an x86-64 style radix page table (9 bits per level:
+//     4 levels for 4K, 3 for 2M, 2 for 1G pages); every PTE read is issued
+//     as a read to 'walker' (the cache hierarchy), one level after another
+//  -- a fully associative page walk cache (PWC) keeps non-leaf entries,
+//     so a walk starts below the deepest cached level
+//  -- concurrent misses to the same page share one walk
+//  -- frames of the lower 7/8 of physical memory are handed out on first
+//     touch (aligned to the page size), so distinct virtual pages never
+//     share a frame until the data region is used up (then allocation wraps
+//     around); page tables live in the top 1/8
+//  -- a hit translates with the frame held in the TLB entry
+
+enum class PageSize { SIZE_4K, SIZE_2M, SIZE_1G };
+constexpr int NUM_PAGE_SIZES = 3;
+
+// Virtual address range [vbase, vbase + size) mapped with 'page_size' pages
+struct PageRegion {
+    uint64_t vbase;
+    uint64_t size;
+    PageSize page_size;
+};
+
+struct TLBEntry {
+    uint64_t tag   = 0;
+    bool     valid = false;
+    uint64_t pfn   = 0;
+};
+
+struct TLBStats {
+    uint64_t lookups        = 0;
+    uint64_t hits           = 0;
+    uint64_t misses         = 0;   // includes misses merged into an in-flight walk
+    uint64_t walks          = 0;
+    uint64_t walk_accesses  = 0;   // PTE reads issued to the cache hierarchy
+    uint64_t pwc_hits       = 0;   // walks that skipped levels thanks to the PWC
+    uint64_t size_lookups[NUM_PAGE_SIZES] = {};   // indexed by PageSize
+    uint64_t size_hits[NUM_PAGE_SIZES]    = {};
+    LatencyHistogram walk_latency;
+};
+
+class TLB : public ICache {
+public:
+    // 'entries' / 'assoc' is the geometry of each page size array;
+    // throws std::invalid_argument unless 0 < assoc <= entries
+    TLB(std::string name, size_t entries, size_t assoc, PageSize page_size, size_t pwc_entries,
+        int hit_lt, uint64_t phys_size, EventSimulator& sim, ICache& cache, ICache& walker, Logger& logger);
+
+    // Map [vbase, vbase + size) with 'page_size' pages (e.g. the heap on 2M pages);
+    // the first matching region wins, vbase and size should be page aligned
+    void map_region(uint64_t vbase, uint64_t size, PageSize page_size);
+
+    // ICache: virtual address in, translated access to 'cache' out
+    void read(uint64_t addr, Completion done = nullptr) override;
+    void write(uint64_t addr, Completion done = nullptr) override;
+    bool snoop_read(uint64_t addr) override { return cache.snoop_read(addr); }
+    bool snoop_write(uint64_t addr) override { return cache.snoop_write(addr); }
+    std::string name() const override { return tlb_name; }
+    void print_stats(std::ostream& os) const override;
+
+    // Physical address of a virtual one (no timing; allocates the frame on first touch)
+    uint64_t translate(uint64_t vaddr);
+
+private:
+    using SetType = Set<TLBEntry, LRUEviction>;
+
+    struct PendingAccess {
+        uint64_t   vaddr;
+        bool       is_write;
+        Completion done;
+    };
+
+    std::string tlb_name;
+    PageSize default_size;
+    int hit_lt;
+    uint64_t phys_size;
+    uint64_t pt_base;    // page table region [pt_base, phys_size)
+
+    std::vector<PageRegion> regions;
+    std::vector<SetType> sets[NUM_PAGE_SIZES];   // one array per page size
+    SetType pwc;         // one fully associative set
+
+    EventSimulator& sim;
+    ICache& cache;
+    ICache& walker;
+    Logger& logger;
+
+    std::unordered_map<uint64_t, uint64_t> page_frames;   // page key --> frame base address
+    uint64_t next_paddr = 0;
+
+    std::unordered_map<uint64_t, std::vector<PendingAccess>> pending_walks;  // page key --> waiters
+    TLBStats stats;
+
+    void access(uint64_t vaddr, bool is_write, Completion done);
+    void issue(uint64_t paddr, bool is_write, Completion done);
+    SimTask walk(PageSize size, uint64_t vpn);
+
+    TLBEntry* find_entry(PageSize size, uint64_t vpn);
+    void fill_entry(PageSize size, uint64_t vpn);
+    TLBEntry* find_pwc(int level, uint64_t vaddr);
+    void fill_pwc(int level, uint64_t vaddr);
+
+    PageSize page_size_of(uint64_t vaddr) const;
+    uint64_t frame_of(PageSize size, uint64_t vpn);
+    uint64_t pte_addr(int level, uint64_t vaddr) const;
+
+    // (page size, vpn) packed into one map key
+    static uint64_t page_key(PageSize size, uint64_t vpn) { return (vpn << 2) | uint64_t(size); }
+    static int levels_of(PageSize size) { return 4 - static_cast<int>(size); }   // 4 / 3 / 2 levels
+    static int page_shift_of(PageSize size) { return level_shift(levels_of(size) - 1); }
+    static int level_shift(int level) { return 12 + 9 * (3 - level); }   // VA bits below level's index
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------
+//    SLAB ARENA                                       |
+// -----------------------------------------------------
+//  -- hands out objects from fixed size slabs, never moves them
+//    (pointers into the arena stay valid for its whole lifetime)
+//  -- objects are destroyed together with the arena
+template <typename T, size_t SLAB_OBJECTS = 256>
+class SlabArena {
+public:
+    SlabArena() = default;
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+    ~SlabArena() {
+        for (size_t i = 0; i < count; i++) slot(i)->~T();
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (count == slabs.size() * SLAB_OBJECTS)
+            slabs.emplace_back(new Storage[SLAB_OBJECTS]);
+        T* obj = new (slot(count)) T(std::forward<Args>(args)...);
+        count++;
+        return obj;
+    }
+    size_t size() const { return count; }
+
+private:
+    struct Storage { alignas(T) unsigned char bytes[sizeof(T)]; };
+    std::vector<std::unique_ptr<Storage[]>> slabs;
+    size_t count = 0;
+
+    T* slot(size_t i) { return reinterpret_cast<T*>(slabs[i / SLAB_OBJECTS][i % SLAB_OBJECTS].bytes); }
+};
+
+// -----------------------------------------------------
+//    SPAN ARENA                                       |
+// -----------------------------------------------------
+//  -- hands out contiguous runs of default constructed T (e.g. the ways
+//     of one set) carved from large slabs, never moves them
+//  -- a run larger than a slab gets a slab of its own
+template <typename T, size_t SLAB_OBJECTS = 4096>
+class SpanArena {
+public:
+    std::span<T> allocate(size_t n) {
+        if (slabs.empty() || used + n > capacity) {
+            capacity = n > SLAB_OBJECTS ? n : SLAB_OBJECTS;
+            slabs.emplace_back(new T[capacity]());
+            used = 0;
+        }
+        std::span<T> run(slabs.back().get() + used, n);
+        used += n;
+        return run;
+    }
+
+private:
+    std::vector<std::unique_ptr<T[]>> slabs;
+    size_t capacity = 0;
+    size_t used     = 0;
+};
+
+// -----------------------------------------------------
+//    TAG STORE                                        |
+// -----------------------------------------------------
+//  -- DENSE  : all sets are built up front, their lines in one run
+//              (small caches, fastest lookup)
+//  -- SPARSE : a set and its 'assoc' lines are carved from the slab arenas
+//              on first touch; untouched sets cost nothing, so very large
+//              caches start instantly and memory scales with the sets a
+//              trace actually uses (the set index and the per set LRU
+//              order still live on the heap)
+enum class TagStoreMode { DENSE, SPARSE };
+
+template <typename SetType>
+class TagStore {
+public:
+    TagStore(TagStoreMode mode, size_t num_sets, size_t assoc)
+        : mode(mode), num_sets(num_sets), assoc(assoc) {
+        if (mode == TagStoreMode::DENSE) {
+            auto all = lines.allocate(num_sets * assoc);
+            dense.reserve(num_sets);
+            for (size_t i = 0; i < num_sets; i++) dense.emplace_back(all.subspan(i * assoc, assoc));
+        }
+    }
+
+    // Set for an access; materializes it on first touch in SPARSE mode
+    SetType& at(uint64_t set_idx) {
+        if (mode == TagStoreMode::DENSE) return dense[set_idx];
+        auto [it, inserted] = sparse.try_emplace(set_idx, nullptr);
+        if (inserted) it->second = arena.create(lines.allocate(assoc));
+        return *it->second;
+    }
+
+    // Set for a lookup that must not allocate (e.g. snoops); nullptr if never touched
+    SetType* peek(uint64_t set_idx) {
+        if (mode == TagStoreMode::DENSE) return &dense[set_idx];
+        auto it = sparse.find(set_idx);
+        return it == sparse.end() ? nullptr : it->second;
+    }
+
+    size_t materialized() const { return mode == TagStoreMode::DENSE ? num_sets : arena.size(); }
+    size_t size() const { return num_sets; }
+
+private:
+    TagStoreMode mode;
+    size_t num_sets;
+    size_t assoc;
+    std::vector<SetType> dense;
+    std::unordered_map<uint64_t, SetType*> sparse;
+    SlabArena<SetType> arena;
+    SpanArena<typename SetType::WayType> lines;
+};
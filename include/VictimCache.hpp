@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// -----------------------------------------------------
+//    VICTIM CACHE                                     |
+// -----------------------------------------------------
+//  -- small fully associative buffer of lines evicted from a Cache
+//  -- keyed by block address (addr >> blk_offset); O(1) lookup through a
+//     block --> slot index, LRU replacement among the slots
+//  -- keeps the coherence state of each line, so it can answer snoops
+//  -- no data and no writebacks are modeled (like the rest of the simulator),
+//     a line dropped from the buffer simply disappears
+struct VictimStats {
+    uint64_t probes        = 0;
+    uint64_t hits          = 0;
+    uint64_t inserts       = 0;
+    uint64_t drops         = 0;   // LRU lines pushed out by an insert
+    uint64_t snoop_hits    = 0;
+    uint64_t invalidations = 0;   // lines removed by a snoop_write / invalidate
+};
+
+template <typename State>
+class VictimCache {
+public:
+    struct Entry {
+        uint64_t blk_addr = 0;
+        State    state{};
+        uint64_t last_use = 0;
+        bool     valid    = false;
+    };
+
+    VictimStats stats;
+
+    void configure(size_t num_entries) {
+        slots.assign(num_entries, Entry{});
+        index.clear();
+        index.reserve(num_entries);
+    }
+    bool enabled() const { return !slots.empty(); }
+
+    // Entry holding 'blk_addr', or nullptr (no stats, no LRU update; used by snoops)
+    Entry* find(uint64_t blk_addr) {
+        auto it = index.find(blk_addr);
+        return it == index.end() ? nullptr : &slots[it->second];
+    }
+
+    // Probe on a miss; on hit the line leaves the buffer (it is swapped into the cache)
+    bool extract(uint64_t blk_addr, State& state) {
+        stats.probes++;
+        auto it = index.find(blk_addr);
+        if (it == index.end()) return false;
+        stats.hits++;
+        state = slots[it->second].state;
+        slots[it->second].valid = false;
+        index.erase(it);
+        return true;
+    }
+
+    // Line evicted from the cache; replaces a free slot or the LRU one
+    void insert(uint64_t blk_addr, State state) {
+        stats.inserts++;
+        size_t slot = 0;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!slots[i].valid) { slot = i; break; }
+            if (slots[i].last_use < slots[slot].last_use) slot = i;
+        }
+        if (slots[slot].valid) {
+            stats.drops++;
+            index.erase(slots[slot].blk_addr);
+        }
+        slots[slot] = Entry{blk_addr, state, ++use_clock, true};
+        index[blk_addr] = slot;
+    }
+
+    void invalidate(uint64_t blk_addr) {
+        auto it = index.find(blk_addr);
+        if (it == index.end()) return;
+        stats.invalidations++;
+        slots[it->second].valid = false;
+        index.erase(it);
+    }
+
+    void print_stats(std::ostream& os) const {
+        os << "  victim cache      " << slots.size() << " entries: "
+           << stats.probes << " probes, " << stats.hits << " hits, "
+           << stats.inserts << " inserts, " << stats.drops << " drops, "
+           << stats.snoop_hits << " snoop hits, " << stats.invalidations << " invalidations\n";
+    }
+
+private:
+    std::vector<Entry> slots;
+    std::unordered_map<uint64_t, size_t> index;   // blk_addr --> slot
+    uint64_t use_clock = 0;
+};
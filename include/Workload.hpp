@@ -0,0 +1,193 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "EventSimulator.hpp"
+
+class ICache; // forward declaration
+
+// -----------------------------------------------------
+//    SYNTHETIC WORKLOADS                              |
+// -----------------------------------------------------
+//  -- every workload is a lazy stream: next() produces one access at a time
+//     and nothing is materialized up front
+//  -- every workload is seeded, so the same parameters give the same stream
+//  -- multi-core patterns (producer/consumer, migratory, false sharing, lock
+//     contention) are built as one stream per core, parameterized by core id
+//  -- constructors throw std::invalid_argument on parameters that cannot
+//     produce a valid stream (empty footprint, ratio outside [0, 1], ...)
+
+struct Access {
+    uint64_t addr     = 0;
+    bool     is_write = false;
+};
+
+struct IWorkload {
+    // Produce the next access into 'out'; returns false once the stream is exhausted
+    virtual bool next(Access& out) = 0;
+    virtual ~IWorkload() = default;
+};
+
+// ---------------- Strided / sequential ---------------
+//  -- addr = base + (i * stride) % footprint
+class StridedWorkload : public IWorkload {
+public:
+    StridedWorkload(uint64_t base, uint64_t stride, uint64_t footprint, uint64_t count,
+                    double write_ratio = 0.0, uint64_t seed = 1);
+    bool next(Access& out) override;
+
+private:
+    uint64_t base, stride, footprint, count;
+    uint64_t issued = 0;
+    uint64_t offset = 0;
+    std::bernoulli_distribution is_write;
+    std::mt19937_64 rng;
+};
+
+// sequential stream is a strided stream with a one-block stride
+class SequentialWorkload : public StridedWorkload {
+public:
+    SequentialWorkload(uint64_t base, uint64_t blk_size, uint64_t footprint, uint64_t count,
+                       double write_ratio = 0.0, uint64_t seed = 1)
+        : StridedWorkload(base, blk_size, footprint, count, write_ratio, seed) {}
+};
+
+// ---------------- Uniform random ---------------------
+//  -- block aligned addresses drawn uniformly from [base, base + footprint)
+class UniformRandomWorkload : public IWorkload {
+public:
+    UniformRandomWorkload(uint64_t base, uint64_t blk_size, uint64_t footprint, uint64_t count,
+                          double write_ratio = 0.0, uint64_t seed = 1);
+    bool next(Access& out) override;
+
+private:
+    uint64_t base, blk_size, count;
+    uint64_t issued = 0;
+    std::uniform_int_distribution<uint64_t> line;
+    std::bernoulli_distribution is_write;
+    std::mt19937_64 rng;
+};
+
+// ---------------- Zipfian hot set --------------------
+//  -- line k (0 = hottest) of a 'num_lines' hot set is drawn with P ~ 1 / (k+1)^alpha
+//  -- only the CDF of the hot set is kept (num_lines doubles), never the stream
+class ZipfWorkload : public IWorkload {
+public:
+    ZipfWorkload(uint64_t base, uint64_t blk_size, uint64_t num_lines, double alpha, uint64_t count,
+                 double write_ratio = 0.0, uint64_t seed = 1);
+    bool next(Access& out) override;
+
+private:
+    uint64_t base, blk_size, count;
+    uint64_t issued = 0;
+    std::vector<double> cdf;
+    std::uniform_real_distribution<double> uniform;
+    std::bernoulli_distribution is_write;
+    std::mt19937_64 rng;
+};
+
+// ---------------- Pointer chasing --------------------
+//  -- visits all 'num_nodes' nodes (power of two) in a seeded pseudo-random cycle
+//  -- the cycle is a full-period LCG (a = 1 mod 4, c odd), so no node list is stored
+//  -- every access depends on the previous one; pair with a Core limited to one
+//     outstanding access to model the serialized latency
+class PointerChaseWorkload : public IWorkload {
+public:
+    PointerChaseWorkload(uint64_t base, uint64_t node_size, uint64_t num_nodes, uint64_t count,
+                         uint64_t seed = 1);
+    bool next(Access& out) override;
+
+private:
+    uint64_t base, node_size, mask, count;
+    uint64_t issued = 0;
+    uint64_t node   = 0;
+    uint64_t mul    = 1;
+    uint64_t inc    = 1;
+};
+
+// ---------------- Producer / consumer ----------------
+//  -- both sides sweep the same ring buffer of 'num_lines' blocks;
+//     the producer writes each block, the consumer reads it
+class ProducerConsumerWorkload : public IWorkload {
+public:
+    enum class Role { PRODUCER, CONSUMER };
+    ProducerConsumerWorkload(Role role, uint64_t base, uint64_t blk_size, uint64_t num_lines, uint64_t count);
+    bool next(Access& out) override;
+
+private:
+    Role role;
+    uint64_t base, blk_size, num_lines, count;
+    uint64_t issued = 0;
+};
+
+// ---------------- Migratory sharing ------------------
+//  -- each core does read-modify-write (read then write) on the shared lines,
+//     starting at line 'core_id', so every line migrates from core to core
+class MigratoryWorkload : public IWorkload {
+public:
+    MigratoryWorkload(int core_id, uint64_t base, uint64_t blk_size, uint64_t num_lines, uint64_t count);
+    bool next(Access& out) override;
+
+private:
+    uint64_t base, blk_size, num_lines, count;
+    uint64_t issued = 0;
+    uint64_t line;
+};
+
+// ---------------- False sharing ----------------------
+//  -- each core read-modify-writes its own 'word_size' word inside shared blocks:
+//     word 'core_id' of block i, for i cycling over 'num_lines' blocks
+class FalseSharingWorkload : public IWorkload {
+public:
+    FalseSharingWorkload(int core_id, uint64_t base, uint64_t blk_size, uint64_t word_size,
+                         uint64_t num_lines, uint64_t count);
+    bool next(Access& out) override;
+
+private:
+    uint64_t base, blk_size, word_offset, num_lines, count;
+    uint64_t issued = 0;
+};
+
+// ---------------- Lock contention --------------------
+//  -- test-and-test-and-set style lock, one stream per contending core:
+//     spin reads on the lock (seeded 1..max_spin), acquire write,
+//     read-modify-write of 'cs_lines' shared blocks, release write
+class LockContentionWorkload : public IWorkload {
+public:
+    LockContentionWorkload(int core_id, uint64_t lock_addr, uint64_t cs_base, uint64_t blk_size,
+                           uint64_t cs_lines, int max_spin, uint64_t count, uint64_t seed = 1);
+    bool next(Access& out) override;
+
+private:
+    enum class Phase { SPIN, ACQUIRE, CS_READ, CS_WRITE, RELEASE };
+    uint64_t lock_addr, cs_base, blk_size, cs_lines, count;
+    uint64_t issued  = 0;
+    Phase    phase   = Phase::SPIN;
+    int      spins   = 0;
+    uint64_t cs_line = 0;
+    std::uniform_int_distribution<int> spin_count;
+    std::mt19937_64 rng;
+};
+
+// -----------------------------------------------------
+//    OPEN LOOP DRIVER                                 |
+// -----------------------------------------------------
+//  -- streams a workload into one cache: one access every 'interval' cycles
+//  -- only the next access is ever scheduled, the stream is pulled lazily
+class WorkloadDriver {
+public:
+    WorkloadDriver(EventSimulator& sim, ICache& cache, IWorkload& workload, uint64_t interval = 1);
+
+    // schedule the first access at 'start_time'
+    void start(uint64_t start_time);
+    uint64_t issued() const { return num_issued; }
+
+private:
+    EventSimulator& sim;
+    ICache& cache;
+    IWorkload& workload;
+    uint64_t interval;
+    uint64_t num_issued = 0;
+
+    void issue_next();
+};
@@ -0,0 +1,123 @@
+#include "Arbiter.hpp"
+#include <algorithm>
+
+// priority of a request type, higher wins (default fixed priority order)
+static int type_priority(BusReqType type) {
+    switch (type) {
+        case BusReqType::INVALIDATE:         return 4;
+        case BusReqType::SNOOP_WRITE:        return 3;
+        case BusReqType::SNOOP_READ:         return 2;
+        case BusReqType::WRITE_MISS_SERVICE: return 1;
+        case BusReqType::READ_MISS_SERVICE:  return 0;
+    }
+    return 0;
+}
+
+// ---------------- FIFO -------------------------------
+BusReq FIFOArbiter::pop(uint64_t now) {
+    BusReq req = std::move(queue.front());
+    queue.pop_front();
+    return req;
+}
+
+// ---------------- Round robin per source -------------
+void RoundRobinArbiter::push(BusReq req) {
+    if (req.source_id >= queues.size()) queues.resize(req.source_id + 1);
+    queues[req.source_id].push_back(std::move(req));
+    pending++;
+}
+
+BusReq RoundRobinArbiter::pop(uint64_t now) {
+    while (queues[next].empty()) next = (next + 1) % queues.size();
+    BusReq req = std::move(queues[next].front());
+    queues[next].pop_front();
+    pending--;
+    next = (next + 1) % queues.size();   // next grant starts at the following source
+    return req;
+}
+
+// ---------------- Fixed priority by type -------------
+FixedPriorityArbiter::FixedPriorityArbiter()
+    : FixedPriorityArbiter({BusReqType::INVALIDATE, BusReqType::SNOOP_WRITE, BusReqType::SNOOP_READ,
+                            BusReqType::WRITE_MISS_SERVICE, BusReqType::READ_MISS_SERVICE}) {}
+
+FixedPriorityArbiter::FixedPriorityArbiter(std::vector<BusReqType> order) : order(std::move(order)) {}
+
+void FixedPriorityArbiter::push(BusReq req) {
+    queues[static_cast<int>(req.type)].push_back(std::move(req));
+    pending++;
+}
+
+BusReq FixedPriorityArbiter::pop(uint64_t now) {
+    // types missing from 'order' are served last, in enum order
+    for (BusReqType type : order) {
+        auto& q = queues[static_cast<int>(type)];
+        if (q.empty()) continue;
+        BusReq req = std::move(q.front());
+        q.pop_front();
+        pending--;
+        return req;
+    }
+    for (auto& q : queues) {
+        if (q.empty()) continue;
+        BusReq req = std::move(q.front());
+        q.pop_front();
+        pending--;
+        return req;
+    }
+    return BusReq();   // unreachable when !empty()
+}
+
+// ---------------- Weighted fair queuing --------------
+WeightedFairArbiter::WeightedFairArbiter(std::vector<double> weights) : weights(std::move(weights)) {}
+
+void WeightedFairArbiter::push(BusReq req) {
+    size_t src = req.source_id;
+    if (src >= queues.size()) {
+        queues.resize(src + 1);
+        last_finish.resize(src + 1, 0.0);
+    }
+    double weight = (src < weights.size() && weights[src] > 0.0) ? weights[src] : 1.0;
+    double cost   = double(std::max<uint64_t>(req.delay, 1));
+    double finish = std::max(virtual_time, last_finish[src]) + cost / weight;
+    last_finish[src] = finish;
+    queues[src].emplace_back(finish, std::move(req));
+    pending++;
+}
+
+BusReq WeightedFairArbiter::pop(uint64_t now) {
+    // per source tags are increasing, so the smallest tag is at one of the heads
+    size_t best = queues.size();
+    for (size_t src = 0; src < queues.size(); src++) {
+        if (queues[src].empty()) continue;
+        if (best == queues.size()) { best = src; continue; }
+        const auto& cand = queues[src].front();
+        const auto& cur  = queues[best].front();
+        if (cand.first < cur.first || (cand.first == cur.first && cand.second.issue_time < cur.second.issue_time))
+            best = src;
+    }
+    virtual_time = queues[best].front().first;
+    BusReq req = std::move(queues[best].front().second);
+    queues[best].pop_front();
+    pending--;
+    return req;
+}
+
+// ---------------- Age based anti-starvation ----------
+AgeBasedArbiter::AgeBasedArbiter(uint64_t aging_quantum) : aging_quantum(aging_quantum ? aging_quantum : 1) {}
+
+BusReq AgeBasedArbiter::pop(uint64_t now) {
+    // queue is in arrival order, so strict '>' keeps the oldest on ties
+    auto best = queue.begin();
+    uint64_t best_prio = 0;
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        uint64_t prio = type_priority(it->type) + (now - it->issue_time) / aging_quantum;
+        if (it == queue.begin() || prio > best_prio) {
+            best      = it;
+            best_prio = prio;
+        }
+    }
+    BusReq req = std::move(*best);
+    queue.erase(best);
+    return req;
+}
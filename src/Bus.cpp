@@ -1,17 +1,33 @@
 #include "Bus.hpp"
 #include "Cache.hpp"
+#include "BusTrace.hpp"
+#include "Arbiter.hpp"
 #include <ios>
+#include <memory>
 #include <sstream>
 
 Bus::Bus(EventSimulator& sim, Logger& logger) 
-    : sim(sim), logger(logger) {}
+    : sim(sim), logger(logger), arbiter(std::make_unique<FIFOArbiter>()) {}
+
+Bus::~Bus() = default;
+
+void Bus::set_arbiter(std::unique_ptr<IArbiter> arb) {
+    arbiter = std::move(arb);
+}
 
 void Bus::register_cache(ICache* cache) {
     caches.push_back(cache);
 }
 
 void Bus::request_grant(const BusReq& req) {
-    queue.push_back(req);
+    BusReq queued = req;
+    queued.issue_time = sim.now();
+    if (queued.source) {
+        for (size_t i = 0; i < caches.size(); i++)
+            if (caches[i] == queued.source) queued.source_id = static_cast<uint16_t>(i);
+    }
+    if (capture) capture->record(queued);
+    arbiter->push(std::move(queued));
     if (!bus_busy) {
         bus_busy = true;
         // schedule the next process 
@@ -19,19 +35,26 @@ void Bus::request_grant(const BusReq& req) {
     }
 }
 
+// replayed requests have no source cache, only the captured id
+std::string Bus::source_name(const BusReq& req) const {
+    return req.source ? req.source->name() : "src" + std::to_string(req.source_id);
+}
+
 // Call this function whenever some bus grant request ends 
 void Bus::process_next() {
-    if (queue.empty()){
+    if (arbiter->empty()){
         bus_busy = false;
         return;
     }
 
-    BusReq req = queue.front();
-    queue.pop_front();
+    BusReq req = arbiter->pop(sim.now());
+    queue_delay.record(sim.now() - req.issue_time);
+    if (req.source_id >= source_wait.size()) source_wait.resize(req.source_id + 1);
+    source_wait[req.source_id].record(sim.now() - req.issue_time);
 
     std::ostringstream oss;
     oss << "Bus :: processing (type = " << static_cast<int>(req.type)
-        << ") from Cache_" << req.source->name() 
+        << ") from Cache_" << source_name(req) 
         << " addr(0x" << std::hex << req.addr << std::dec << ")";
     logger.log(sim.now(), oss.str());
 
@@ -55,150 +78,92 @@ void Bus::process_next() {
     }
 }
 
+// One event at now + delay probes every target in registration order and aggregates the 
+// responses in place; completion (callback, then process_next) follows as before 
 void Bus::execute_snoop(const BusReq& req){
-    // count how many target caches for snoop 
-    int targets = 0;
-    for (auto* cache : caches){
-        if (cache != req.source) ++targets;
-    }
-    
-    // shared state for aggregating snoop responses 
-    struct SnoopState {
-        BusReq req;
-        int remaining = 0;
-        bool any_success = false; 
-        Bus* bus = nullptr;
-    };
-    auto state = std::make_shared<SnoopState>();
-    state->req = req;
-    state->bus = this;
-    state->remaining = targets; 
-
-    // if no other caches, complete immediately after delay 
-    if (targets == 0){
-        sim.schedule(sim.now() + req.delay, [state](){
-            if (state->req.callback){
-                state->req.callback(false);  // no data found 
-            }
-            // continue with next bus request 
-            state->bus->sim.schedule(state->bus->sim.now(), [state](){ state->bus->process_next(); });
-        });
-        return;
-    }
-
-    // else, schedule snoop to each target cache 
-    for (auto* cache : caches) {
-        if (cache == req.source) continue;
+    sim.schedule(sim.now() + req.delay, [this, req](){
+        int targets = 0;
+        bool any_success = false;
+        for (auto* cache : caches) {
+            if (cache == req.source) continue;
+            ++targets;
 
-        sim.schedule(sim.now() + req.delay, [cache, state](){
-            bool snoop_success = false; 
-            if (state->req.type == BusReqType::SNOOP_WRITE || state->req.type == BusReqType::INVALIDATE) {
-                snoop_success = cache->snoop_write(state->req.addr);
-            } else {
-                snoop_success = cache->snoop_read(state->req.addr);
-            }
-            if (snoop_success)  state->any_success = true; 
+            bool snoop_success = (req.type == BusReqType::SNOOP_WRITE || req.type == BusReqType::INVALIDATE)
+                               ? cache->snoop_write(req.addr)
+                               : cache->snoop_read(req.addr);
+            any_success |= snoop_success;
 
             // log snoop response 
-            {
-                std::ostringstream oss;
-                oss << "Bus :: Cache_" << state->req.source->name()
-                    << " snooped Cache_" << cache->name()
-                    << " addr(0x" << std::hex << state->req.addr << std::dec            
-                    << ") --> " << (snoop_success ? "SNOOP_HIT" : "SNOOP_MISS");
-                state->bus->logger.log(state->bus->sim.now(), oss.str());
-            }
-
-            // last responder triggers completion of SNOOP broadcast 
-            if (--(state->remaining) == 0) {
-                state->bus->sim.schedule(state->bus->sim.now(), [state](){
-                    if (state->req.callback) {
-                        state->req.callback(state->any_success);
-                    }
-                    // continue with next bus request 
-                    state->bus->sim.schedule(state->bus->sim.now(), [state](){ state->bus->process_next(); });
-                });
-            }
-        });
-    }
-}
-
-// TODO : for now this simulates main memory. Connect top/main_mem module later 
-void Bus::execute_data_service(const BusReq& req) {
-    // Simulates Main memory serving the data 
-    sim.schedule(sim.now() + req.delay, [this, req](){
-        std::ostringstream oss;
-        oss << "Bus :: Data service completed for Cache_" << req.source->name()
-            << " addr(0x" << std::hex << req.addr << std::dec << ")";
-        logger.log(sim.now(), oss.str());
-
-        if(req.callback) req.callback(true); // true because we assume data always available at higher level 
-     
-        // Continue with next bus request 
-        sim.schedule(sim.now(), [this](){ this->process_next(); });
+            std::ostringstream oss;
+            oss << "Bus :: Cache_" << source_name(req)
+                << " snooped Cache_" << cache->name()
+                << " addr(0x" << std::hex << req.addr << std::dec
+                << ") --> " << (snoop_success ? "SNOOP_HIT" : "SNOOP_MISS");
+            logger.log(sim.now(), oss.str());
+        }
+        complete_broadcast(req, targets, any_success);
     });
 }
 
-void Bus::execute_invalidate(const BusReq& req){
-    // broadcast invalidate to all caches except source 
-    int targets = 0;
-    for (auto* cache : caches){
-        if (cache != req.source) ++targets;
-    }
-    
-    struct InavlidateState {
-        BusReq req;
-        int remaining = 0;
-        Bus* bus = nullptr;
-    };
-    auto state = std::make_shared<InavlidateState>();
-    state->bus = this;
-    state->remaining = targets; 
-    state->req = req; 
-
-    // if there are no other caches, complete the request immediately
-    if (targets == 0) {
-        sim.schedule(sim.now() + req.delay, [state]() {
-            if (state->req.callback) state->req.callback(false);
-            state->bus->sim.schedule(state->bus->sim.now(), [state]() { state->bus->process_next(); });
-        });
-        return;
-    }
+// Data is served by the attached memory model (set_memory), else by the request's own latency 
+SimTask Bus::execute_data_service(BusReq req) {
+    // Cache-to-cache transfers keep their own latency, the rest is served by memory 
+    uint64_t latency = (memory && !req.c2c) ? memory->access(req, sim.now()) : req.delay;
+    co_await sim.delay(latency);
 
-    for ( auto* cache : caches ) {
-        if (cache == req.source) continue;
+    std::ostringstream oss;
+    oss << "Bus :: Data service completed for Cache_" << source_name(req)
+        << " addr(0x" << std::hex << req.addr << std::dec << ")";
+    logger.log(sim.now(), oss.str());
 
-        sim.schedule(sim.now() + req.delay, [cache, state]() {
-            cache->snoop_write(state->req.addr); // invalidate is a form of snoop_write 
-            
-            std::ostringstream oss;
-            oss << "Bus :: Cache_" << state->req.source->name() 
-                << " invalidated Cache_" << cache->name() 
-                << " addr(0x" << std::hex << state->req.addr << std::dec <<")";
-            state->bus->logger.log(state->bus->sim.now(), oss.str());
-
-            if (--(state->remaining) == 0) {
-                state->bus->sim.schedule(state->bus->sim.now(), [state](){
-                    if (state->req.callback) state->req.callback(true);
-                    state->bus->sim.schedule(state->bus->sim.now(), [state](){ state->bus->process_next(); });
-                });
-            }
-        });
-    }
+    if(req.callback) req.callback(true); // true because we assume data always available at higher level 
 
+    // Continue with next bus request 
+    co_await sim.delay(0);
+    process_next();
 }
 
+void Bus::execute_invalidate(const BusReq& req){
+    // broadcast invalidate to all caches except source, in one event 
+    sim.schedule(sim.now() + req.delay, [this, req](){
+        int targets = 0;
+        for (auto* cache : caches) {
+            if (cache == req.source) continue;
+            ++targets;
 
+            cache->snoop_write(req.addr); // invalidate is a form of snoop_write 
 
+            std::ostringstream oss;
+            oss << "Bus :: Cache_" << source_name(req)
+                << " invalidated Cache_" << cache->name()
+                << " addr(0x" << std::hex << req.addr << std::dec <<")";
+            logger.log(sim.now(), oss.str());
+        }
+        complete_broadcast(req, targets, true);
+    });
+}
 
+// Broadcast completion: callback one event after the probes, then the next bus request 
+// (no targets --> callback right away, the old per-target path had no response event either) 
+void Bus::complete_broadcast(const BusReq& req, int targets, bool result){
+    if (targets == 0) {
+        if (req.callback) req.callback(false);
+        sim.schedule(sim.now(), [this](){ process_next(); });
+        return;
+    }
+    sim.schedule(sim.now(), [this, callback = req.callback, result](){
+        if (callback) callback(result);
+        sim.schedule(sim.now(), [this](){ process_next(); });
+    });
+}
 
-
-
-
-
-
-
-
-
-
-
+void Bus::print_stats(std::ostream& os) const {
+    os << "---------- Bus latency (cycles), arbiter: " << arbiter->name() << " ----------\n";
+    LatencyHistogram::print_header(os);
+    queue_delay.print_row(os, "queue_delay");
+    for (size_t i = 0; i < source_wait.size(); i++) {
+        if (source_wait[i].count() == 0) continue;
+        std::string src = (i < caches.size()) ? caches[i]->name() : "src" + std::to_string(i);
+        source_wait[i].print_row(os, "  " + src);
+    }
+}
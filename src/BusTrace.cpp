@@ -0,0 +1,99 @@
+#include "BusTrace.hpp"
+#include <stdexcept>
+
+static const char TRACE_MAGIC[6] = {'B', 'U', 'S', 'T', 'R', 'C'};
+static const char TRACE_VERSION  = 1;
+
+// ---------------- Writer -----------------------------
+BusTraceWriter::BusTraceWriter(std::ostream& os) : os(os) {
+    os.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    os.put(TRACE_VERSION);
+}
+
+void BusTraceWriter::put_varint(uint64_t value) {
+    while (value >= 0x80) {
+        os.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    os.put(static_cast<char>(value));
+}
+
+void BusTraceWriter::record(const BusReq& req) {
+    int64_t  addr_delta = static_cast<int64_t>(req.addr - prev_addr);
+    uint64_t zigzag     = (static_cast<uint64_t>(addr_delta) << 1) ^ static_cast<uint64_t>(addr_delta >> 63);
+
+    os.put(static_cast<char>(static_cast<uint8_t>(req.type) | (req.c2c ? 0x08 : 0x00)));
+    put_varint(req.source_id);
+    put_varint(req.issue_time - prev_time);
+    put_varint(zigzag);
+    put_varint(req.delay);
+
+    prev_time = req.issue_time;
+    prev_addr = req.addr;
+    num_records++;
+}
+
+// ---------------- Reader -----------------------------
+BusTraceReader::BusTraceReader(std::istream& is) : is(is) {
+    char header[sizeof(TRACE_MAGIC) + 1] = {};
+    is.read(header, sizeof(header));
+    if (!is || std::char_traits<char>::compare(header, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0
+            || header[sizeof(TRACE_MAGIC)] != TRACE_VERSION)
+        throw std::runtime_error("BusTraceReader: not a bus trace (bad header)");
+}
+
+bool BusTraceReader::get_varint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = is.get();
+        if (byte == std::char_traits<char>::eof()) return false;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool BusTraceReader::next(BusTraceRecord& rec) {
+    int head = is.get();
+    if (head == std::char_traits<char>::eof()) return false;
+
+    uint64_t source_id, time_delta, zigzag, delay;
+    if (!get_varint(source_id) || !get_varint(time_delta) || !get_varint(zigzag) || !get_varint(delay))
+        throw std::runtime_error("BusTraceReader: truncated record");
+
+    int64_t addr_delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    rec.type       = static_cast<BusReqType>(head & 0x07);
+    rec.c2c        = (head & 0x08) != 0;
+    rec.source_id  = static_cast<uint16_t>(source_id);
+    rec.issue_time = prev_time + time_delta;
+    rec.addr       = prev_addr + static_cast<uint64_t>(addr_delta);
+    rec.delay      = delay;
+
+    prev_time = rec.issue_time;
+    prev_addr = rec.addr;
+    return true;
+}
+
+// ---------------- Replay -----------------------------
+BusReplayer::BusReplayer(EventSimulator& sim, Bus& bus, BusTraceReader& reader)
+    : sim(sim), bus(bus), reader(reader) {}
+
+void BusReplayer::start() {
+    has_pending = reader.next(pending);
+    if (has_pending)
+        sim.schedule(pending.issue_time, [this](){ this->issue_batch(); });
+}
+
+// Issue every record captured at this time (in capture order), then schedule the next batch
+void BusReplayer::issue_batch() {
+    while (has_pending && pending.issue_time == sim.now()) {
+        BusReq req(pending.type, nullptr, pending.addr, pending.delay);
+        req.source_id = pending.source_id;
+        req.c2c       = pending.c2c;
+        bus.request_grant(req);
+        num_replayed++;
+        has_pending = reader.next(pending);
+    }
+    if (has_pending)
+        sim.schedule(pending.issue_time, [this](){ this->issue_batch(); });
+}
@@ -0,0 +1,70 @@
+#include "Core.hpp"
+#include "Cache.hpp"
+#include <iomanip>
+
+Core::Core(std::string name, EventSimulator& sim, ICache& cache, IWorkload& workload,
+           int max_outstanding, int issue_width)
+    : core_name(std::move(name)), sim(sim), cache(cache), workload(workload),
+      max_outstanding(max_outstanding), issue_width(issue_width) {}
+
+void Core::start(uint64_t start_time) {
+    start_cycle     = start_time;
+    last_completion = start_time;
+    schedule_issue(start_time);
+}
+
+void Core::schedule_issue(uint64_t time) {
+    if (issue_scheduled) return;
+    issue_scheduled = true;
+    sim.schedule(time, [this](){ this->try_issue(); });
+}
+
+// Issue as many accesses as the window and issue width allow in this cycle
+void Core::try_issue() {
+    issue_scheduled = false;
+    if (sim.now() != issue_cycle) {
+        issue_cycle       = sim.now();
+        issued_this_cycle = 0;
+    }
+
+    while (!stream_done && outstanding < max_outstanding && issued_this_cycle < issue_width) {
+        Access acc;
+        if (!workload.next(acc)) {
+            stream_done = true;
+            break;
+        }
+        outstanding++;
+        issued_this_cycle++;
+        num_issued++;
+        if (acc.is_write) cache.write(acc.addr, [this](){ this->on_complete(); });
+        else              cache.read(acc.addr, [this](){ this->on_complete(); });
+    }
+
+    if (stream_done) return;
+    if (outstanding == max_outstanding) {
+        full_since = sim.now();              // stall until a completion frees a slot
+        return;
+    }
+    schedule_issue(sim.now() + 1);          // issue width used up, continue next cycle
+}
+
+// Completion callback from the cache; frees one window slot
+void Core::on_complete() {
+    if (outstanding == max_outstanding && !stream_done)
+        stall_cycles += sim.now() - full_since;
+    outstanding--;
+    num_completed++;
+    last_completion = sim.now();
+
+    // issue from a fresh event, never from inside the cache's completion
+    if (!stream_done) schedule_issue(sim.now());
+}
+
+void Core::print_stats(std::ostream& os) const {
+    os << "---------- Core_" << core_name << " ----------\n"
+       << "  issued            " << num_issued << "\n"
+       << "  completed         " << num_completed << "\n"
+       << "  cycles            " << cycles() << "\n"
+       << "  window stalls     " << stall_cycles << " cycles\n"
+       << "  accesses/cycle    " << std::fixed << std::setprecision(4) << accesses_per_cycle() << "\n";
+}
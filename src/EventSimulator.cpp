@@ -1,12 +1,14 @@
 #include "EventSimulator.hpp"
+#include <utility>
 
 void EventSimulator::schedule(uint64_t time, std::function<void()> action){
-    event_q.push(Event{time, action});
+    event_q.push(Event{time, next_seq++, std::move(action)});
 }
 
 void EventSimulator::run_sim(){
     while(!event_q.empty()){
-        Event ev = event_q.top();
+        // move out of top() --> the popped slot is destroyed right after, so no copy of the action 
+        Event ev = std::move(const_cast<Event&>(event_q.top()));
         event_q.pop();
         currentTime = ev.time;
         ev.action();
@@ -0,0 +1,20 @@
+#include "Memory.hpp"
+#include "Bus.hpp"
+
+BankedMemory::BankedMemory(int num_banks, uint64_t blk_size, uint64_t row_size, uint64_t row_hit_lt, uint64_t row_miss_lt)
+    : banks(num_banks), blk_size(blk_size), row_size(row_size), row_hit_lt(row_hit_lt), row_miss_lt(row_miss_lt) {}
+
+uint64_t BankedMemory::access(const BusReq& req, uint64_t now) {
+    auto& bank   = banks[(req.addr / blk_size) % banks.size()];
+    uint64_t row = req.addr / row_size;
+
+    uint64_t start = bank.busy_until > now ? bank.busy_until : now;
+    bool row_hit   = bank.row_valid && bank.open_row == row;
+    if (row_hit) num_row_hits++;
+    else         num_row_misses++;
+
+    bank.open_row   = row;
+    bank.row_valid  = true;
+    bank.busy_until = start + (row_hit ? row_hit_lt : row_miss_lt);
+    return bank.busy_until - now;
+}
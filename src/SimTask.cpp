@@ -0,0 +1,34 @@
+#include "SimTask.hpp"
+#include <new>
+
+void* FramePool::allocate(std::size_t size) {
+    std::size_t cls = size_class(size);
+    if (cls >= NUM_CLASSES) return ::operator new(size);
+
+    if (!free_list[cls]) refill(cls);
+    FreeNode* node = free_list[cls];
+    free_list[cls] = node->next;
+    return node;
+}
+
+void FramePool::deallocate(void* ptr, std::size_t size) {
+    std::size_t cls = size_class(size);
+    if (cls >= NUM_CLASSES) {
+        ::operator delete(ptr);
+        return;
+    }
+    auto* node = static_cast<FreeNode*>(ptr);
+    node->next = free_list[cls];
+    free_list[cls] = node;
+}
+
+// Carve one slab into SLAB_FRAMES frames of this class; slabs live for the whole run
+void FramePool::refill(std::size_t cls) {
+    std::size_t frame_size = (cls + 1) * GRANULE;
+    char* slab = static_cast<char*>(::operator new(frame_size * SLAB_FRAMES));
+    for (std::size_t i = 0; i < SLAB_FRAMES; i++) {
+        auto* node = reinterpret_cast<FreeNode*>(slab + i * frame_size);
+        node->next = free_list[cls];
+        free_list[cls] = node;
+    }
+}
@@ -0,0 +1,54 @@
+#include "Stats.hpp"
+#include <cmath>
+#include <iomanip>
+
+uint64_t LatencyHistogram::percentile(double pct) const {
+    if (total == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(std::ceil(pct / 100.0 * double(total)));
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t idx = 0; idx < NUM_BUCKETS; idx++) {
+        seen += counts[idx];
+        if (seen >= target) {
+            uint64_t upper = bucket_upper(idx);
+            return upper < max_value ? upper : max_value;
+        }
+    }
+    return max_value;
+}
+
+void LatencyHistogram::print_header(std::ostream& os) {
+    os << "  " << std::left << std::setw(12) << "class" << std::right
+       << std::setw(10) << "count"
+       << std::setw(10) << "mean"
+       << std::setw(8)  << "min"
+       << std::setw(8)  << "p50"
+       << std::setw(8)  << "p90"
+       << std::setw(8)  << "p99"
+       << std::setw(8)  << "p99.9"
+       << std::setw(8)  << "max" << "\n";
+}
+
+void LatencyHistogram::print_row(std::ostream& os, const std::string& label) const {
+    os << "  " << std::left << std::setw(12) << label << std::right
+       << std::setw(10) << total
+       << std::setw(10) << std::fixed << std::setprecision(2) << mean()
+       << std::setw(8)  << min()
+       << std::setw(8)  << percentile(50.0)
+       << std::setw(8)  << percentile(90.0)
+       << std::setw(8)  << percentile(99.0)
+       << std::setw(8)  << percentile(99.9)
+       << std::setw(8)  << max() << "\n";
+}
+
+void CacheStats::print(std::ostream& os, const std::string& name) const {
+    os << "---------- Cache_" << name << " latency (cycles) ----------\n";
+    LatencyHistogram::print_header(os);
+    hit.print_row(os, "hit");
+    miss.print_row(os, "miss");
+    coalesced.print_row(os, "coalesced");
+    upgrade.print_row(os, "upgrade");
+    if (victim_hit.count()) victim_hit.print_row(os, "victim_hit");
+    if (bank_stall.count()) bank_stall.print_row(os, "bank_stall");
+}
@@ -0,0 +1,225 @@
+#include "TLB.hpp"
+#include <coroutine>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+
+uint64_t mix64(uint64_t x) {   // splitmix64 finalizer
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// co_await on a cache read; resumes from a fresh event once the line is returned
+struct ReadAwaiter {
+    EventSimulator& sim;
+    ICache& cache;
+    uint64_t addr;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        EventSimulator* s = &sim;
+        cache.read(addr, [s, h](){ s->schedule(s->now(), [h](){ h.resume(); }); });
+    }
+    void await_resume() const noexcept {}
+};
+
+} // namespace
+
+TLB::TLB(std::string name, size_t entries, size_t assoc, PageSize page_size, size_t pwc_entries,
+         int hit_lt, uint64_t phys_size, EventSimulator& sim, ICache& cache, ICache& walker, Logger& logger)
+    : tlb_name(std::move(name)), default_size(page_size), hit_lt(hit_lt), phys_size(phys_size),
+      pwc(pwc_entries), sim(sim), cache(cache), walker(walker), logger(logger) {
+    if (assoc == 0 || entries < assoc)
+        throw std::invalid_argument("TLB: need 0 < assoc <= entries");
+    for (auto& array : sets) array.assign(entries / assoc, SetType(assoc));
+    pt_base = phys_size - phys_size / 8;
+}
+
+void TLB::map_region(uint64_t vbase, uint64_t size, PageSize page_size) {
+    regions.push_back(PageRegion{vbase, size, page_size});
+}
+
+// -------------------------------------------------------
+// Translation                                           |
+// -------------------------------------------------------
+PageSize TLB::page_size_of(uint64_t vaddr) const {
+    for (const auto& region : regions)
+        if (vaddr >= region.vbase && vaddr - region.vbase < region.size) return region.page_size;
+    return default_size;
+}
+
+// first touch allocation: one frame per virtual page, in touch order, aligned
+// to the page size (a page larger than the data region starts at 0)
+uint64_t TLB::frame_of(PageSize size, uint64_t vpn) {
+    auto [it, first] = page_frames.try_emplace(page_key(size, vpn), 0);
+    if (first) {
+        uint64_t page_bytes = 1ULL << page_shift_of(size);
+        uint64_t base       = (next_paddr + page_bytes - 1) & ~(page_bytes - 1);
+        if (base + page_bytes > pt_base) base = 0;   // data region used up --> wrap around
+        it->second = base;
+        next_paddr = base + page_bytes;
+    }
+    return it->second;
+}
+
+uint64_t TLB::translate(uint64_t vaddr) {
+    PageSize size  = page_size_of(vaddr);
+    int shift      = page_shift_of(size);
+    uint64_t offset = vaddr & ((1ULL << shift) - 1);
+    return frame_of(size, vaddr >> shift) | offset;
+}
+
+// PTE of 'vaddr' at 'level': the table is picked by the VA bits above the
+// level's index, the entry by the level's 9 index bits (8 byte PTEs)
+uint64_t TLB::pte_addr(int level, uint64_t vaddr) const {
+    uint64_t table_id   = vaddr >> (level_shift(level) + 9);
+    uint64_t idx        = (vaddr >> level_shift(level)) & 511;
+    uint64_t pt_size    = phys_size - pt_base;
+    uint64_t num_tables = pt_size / 4096 ? pt_size / 4096 : 1;
+    uint64_t table      = mix64((uint64_t(level) << 56) ^ table_id) % num_tables;
+    return pt_base + (table * 4096 + idx * 8) % pt_size;
+}
+
+// -------------------------------------------------------
+// TLB / PWC arrays                                      |
+// -------------------------------------------------------
+TLBEntry* TLB::find_entry(PageSize size, uint64_t vpn) {
+    auto& array  = sets[static_cast<int>(size)];
+    auto& set    = array[vpn % array.size()];
+    uint64_t tag = vpn / array.size();
+    for (int i = 0; i < (int)set.ways.size(); i++) {
+        if (set.ways[i].valid && set.ways[i].tag == tag) {
+            set.touch(i);
+            return &set.ways[i];
+        }
+    }
+    return nullptr;
+}
+
+void TLB::fill_entry(PageSize size, uint64_t vpn) {
+    auto& array = sets[static_cast<int>(size)];
+    auto& set   = array[vpn % array.size()];
+    int victim  = set.choose_victim();
+    set.ways[victim] = TLBEntry{vpn / array.size(), true, frame_of(size, vpn) >> page_shift_of(size)};
+    set.touch(victim);
+}
+
+TLBEntry* TLB::find_pwc(int level, uint64_t vaddr) {
+    uint64_t tag = (uint64_t(level) << 58) ^ (vaddr >> level_shift(level));
+    for (int i = 0; i < (int)pwc.ways.size(); i++) {
+        if (pwc.ways[i].valid && pwc.ways[i].tag == tag) {
+            pwc.touch(i);
+            return &pwc.ways[i];
+        }
+    }
+    return nullptr;
+}
+
+void TLB::fill_pwc(int level, uint64_t vaddr) {
+    if (pwc.ways.empty() || find_pwc(level, vaddr)) return;
+    int victim = pwc.choose_victim();
+    pwc.ways[victim] = TLBEntry{(uint64_t(level) << 58) ^ (vaddr >> level_shift(level)), true, 0};
+    pwc.touch(victim);
+}
+
+// -------------------------------------------------------
+// Accesses                                              |
+// -------------------------------------------------------
+void TLB::read(uint64_t addr, Completion done) {
+    access(addr, false, std::move(done));
+}
+
+void TLB::write(uint64_t addr, Completion done) {
+    access(addr, true, std::move(done));
+}
+
+void TLB::issue(uint64_t paddr, bool is_write, Completion done) {
+    if (is_write) cache.write(paddr, std::move(done));
+    else          cache.read(paddr, std::move(done));
+}
+
+void TLB::access(uint64_t vaddr, bool is_write, Completion done) {
+    PageSize size = page_size_of(vaddr);
+    uint64_t vpn  = vaddr >> page_shift_of(size);
+    stats.lookups++;
+    stats.size_lookups[static_cast<int>(size)]++;
+
+    // ----------------- TLB HIT ---------------
+    if (auto* entry = find_entry(size, vpn)) {
+        stats.hits++;
+        stats.size_hits[static_cast<int>(size)]++;
+        int shift      = page_shift_of(size);
+        uint64_t paddr = (entry->pfn << shift) | (vaddr & ((1ULL << shift) - 1));
+        if (hit_lt == 0) {
+            issue(paddr, is_write, std::move(done));
+        } else {
+            sim.schedule(sim.now() + hit_lt, [this, paddr, is_write, done = std::move(done)]() mutable {
+                issue(paddr, is_write, std::move(done));
+            });
+        }
+        return;
+    }
+
+    // ----------------- TLB MISS --------------
+    stats.misses++;
+    logger.log(sim.now(), "TLB_" + tlb_name + " :: TLB_MISS for vaddr(" + to_string(vaddr) + ")");
+    auto [it, first] = pending_walks.try_emplace(page_key(size, vpn));
+    it->second.push_back(PendingAccess{vaddr, is_write, std::move(done)});
+    if (first) walk(size, vpn);   // otherwise merged into the in-flight walk
+}
+
+// Page walk transaction: PWC lookup --> one PTE read per remaining level --> TLB fill
+SimTask TLB::walk(PageSize size, uint64_t vpn) {
+    uint64_t start = sim.now();
+    uint64_t vaddr = vpn << page_shift_of(size);
+    int levels     = levels_of(size);
+    stats.walks++;
+
+    // start below the deepest non-leaf level held in the PWC
+    int first_level = 0;
+    for (int level = levels - 2; level >= 0; level--) {
+        if (find_pwc(level, vaddr)) {
+            first_level = level + 1;
+            stats.pwc_hits++;
+            break;
+        }
+    }
+
+    co_await sim.delay(hit_lt);   // TLB lookup before the walk starts
+    for (int level = first_level; level < levels; level++) {
+        stats.walk_accesses++;
+        co_await ReadAwaiter{sim, walker, pte_addr(level, vaddr)};
+        if (level < levels - 1) fill_pwc(level, vaddr);
+    }
+
+    fill_entry(size, vpn);
+    stats.walk_latency.record(sim.now() - start);
+    logger.log(sim.now(), "TLB_" + tlb_name + " :: WALK DONE for vpn(" + to_string(vpn) + ") -- "
+                          + to_string(levels - first_level) + " levels");
+
+    auto waiters = std::move(pending_walks[page_key(size, vpn)]);
+    pending_walks.erase(page_key(size, vpn));
+    for (auto& w : waiters)
+        issue(translate(w.vaddr), w.is_write, std::move(w.done));
+}
+
+void TLB::print_stats(std::ostream& os) const {
+    double hit_rate = stats.lookups ? 100.0 * double(stats.hits) / double(stats.lookups) : 0.0;
+    os << "---------- TLB_" << tlb_name << " ----------\n"
+       << "  lookups           " << stats.lookups << "\n"
+       << "  hits              " << stats.hits << " (" << std::fixed << std::setprecision(2) << hit_rate << "%)\n"
+       << "  misses            " << stats.misses << "\n"
+       << "  walks             " << stats.walks << "\n"
+       << "  walk accesses     " << stats.walk_accesses << "\n"
+       << "  pwc hits          " << stats.pwc_hits << "\n"
+       << "  pages mapped      " << page_frames.size() << "\n";
+    static const char* size_names[NUM_PAGE_SIZES] = {"4K", "2M", "1G"};
+    for (int i = 0; i < NUM_PAGE_SIZES; i++) {
+        if (stats.size_lookups[i] == 0) continue;
+        os << "  " << size_names[i] << " lookups/hits   " << stats.size_lookups[i] << " / " << stats.size_hits[i] << "\n";
+    }
+    LatencyHistogram::print_header(os);
+    stats.walk_latency.print_row(os, "walk");
+}
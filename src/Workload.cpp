@@ -0,0 +1,205 @@
+#include "Workload.hpp"
+#include "Cache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void require(bool ok, const char* workload, const char* what) {
+    if (!ok) throw std::invalid_argument(std::string(workload) + ": " + what);
+}
+
+double checked_ratio(double write_ratio, const char* workload) {
+    require(write_ratio >= 0.0 && write_ratio <= 1.0, workload, "write_ratio must be in [0, 1]");
+    return write_ratio;
+}
+
+uint64_t checked_count(uint64_t n, const char* workload, const char* what) {
+    require(n > 0, workload, what);
+    return n;
+}
+
+} // namespace
+
+// ---------------- Strided / sequential ---------------
+StridedWorkload::StridedWorkload(uint64_t base, uint64_t stride, uint64_t footprint, uint64_t count,
+                                 double write_ratio, uint64_t seed)
+    : base(base), stride(stride), footprint(checked_count(footprint, "StridedWorkload", "footprint must be > 0")), count(count),
+      is_write(checked_ratio(write_ratio, "StridedWorkload")), rng(seed) {}
+
+bool StridedWorkload::next(Access& out) {
+    if (issued == count) return false;
+    out.addr     = base + offset;
+    out.is_write = is_write(rng);
+    offset = (offset + stride) % footprint;
+    issued++;
+    return true;
+}
+
+// ---------------- Uniform random ---------------------
+UniformRandomWorkload::UniformRandomWorkload(uint64_t base, uint64_t blk_size, uint64_t footprint, uint64_t count,
+                                             double write_ratio, uint64_t seed)
+    : base(base), blk_size(checked_count(blk_size, "UniformRandomWorkload", "blk_size must be > 0")), count(count),
+      line(0, checked_count(footprint / this->blk_size, "UniformRandomWorkload", "footprint must hold at least one block") - 1),
+      is_write(checked_ratio(write_ratio, "UniformRandomWorkload")), rng(seed) {}
+
+bool UniformRandomWorkload::next(Access& out) {
+    if (issued == count) return false;
+    out.addr     = base + line(rng) * blk_size;
+    out.is_write = is_write(rng);
+    issued++;
+    return true;
+}
+
+// ---------------- Zipfian hot set --------------------
+ZipfWorkload::ZipfWorkload(uint64_t base, uint64_t blk_size, uint64_t num_lines, double alpha, uint64_t count,
+                           double write_ratio, uint64_t seed)
+    : base(base), blk_size(blk_size), count(count), cdf(checked_count(num_lines, "ZipfWorkload", "num_lines must be > 0")),
+      uniform(0.0, 1.0), is_write(checked_ratio(write_ratio, "ZipfWorkload")), rng(seed) {
+    require(alpha >= 0.0, "ZipfWorkload", "alpha must be >= 0");
+    double sum = 0.0;
+    for (uint64_t k = 0; k < num_lines; k++) {
+        sum   += 1.0 / std::pow(double(k + 1), alpha);
+        cdf[k] = sum;
+    }
+    for (auto& p : cdf) p /= sum;
+}
+
+bool ZipfWorkload::next(Access& out) {
+    if (issued == count) return false;
+    double u  = uniform(rng);
+    auto   it = std::lower_bound(cdf.begin(), cdf.end(), u);
+    uint64_t k = (it == cdf.end()) ? cdf.size() - 1 : uint64_t(it - cdf.begin());
+    out.addr     = base + k * blk_size;
+    out.is_write = is_write(rng);
+    issued++;
+    return true;
+}
+
+// ---------------- Pointer chasing --------------------
+PointerChaseWorkload::PointerChaseWorkload(uint64_t base, uint64_t node_size, uint64_t num_nodes, uint64_t count,
+                                           uint64_t seed)
+    : base(base), node_size(node_size), mask(num_nodes - 1), count(count) {
+    // the LCG is a full-period permutation only modulo a power of two
+    require(num_nodes > 0 && (num_nodes & (num_nodes - 1)) == 0, "PointerChaseWorkload", "num_nodes must be a power of two");
+    std::mt19937_64 rng(seed);
+    mul  = (rng() << 2) | 1;   // a = 1 mod 4
+    inc  = rng() | 1;          // c odd
+    node = rng() & mask;
+}
+
+bool PointerChaseWorkload::next(Access& out) {
+    if (issued == count) return false;
+    out.addr     = base + node * node_size;
+    out.is_write = false;
+    node = (mul * node + inc) & mask;
+    issued++;
+    return true;
+}
+
+// ---------------- Producer / consumer ----------------
+ProducerConsumerWorkload::ProducerConsumerWorkload(Role role, uint64_t base, uint64_t blk_size, uint64_t num_lines, uint64_t count)
+    : role(role), base(base), blk_size(blk_size), num_lines(checked_count(num_lines, "ProducerConsumerWorkload", "num_lines must be > 0")),
+      count(count) {}
+
+bool ProducerConsumerWorkload::next(Access& out) {
+    if (issued == count) return false;
+    out.addr     = base + (issued % num_lines) * blk_size;
+    out.is_write = (role == Role::PRODUCER);
+    issued++;
+    return true;
+}
+
+// ---------------- Migratory sharing ------------------
+MigratoryWorkload::MigratoryWorkload(int core_id, uint64_t base, uint64_t blk_size, uint64_t num_lines, uint64_t count)
+    : base(base), blk_size(blk_size), num_lines(checked_count(num_lines, "MigratoryWorkload", "num_lines must be > 0")),
+      count(count), line(core_id % this->num_lines) {}
+
+bool MigratoryWorkload::next(Access& out) {
+    if (issued == count) return false;
+    out.addr     = base + line * blk_size;
+    out.is_write = (issued % 2 == 1);          // read, then write the same line
+    if (out.is_write) line = (line + 1) % num_lines;
+    issued++;
+    return true;
+}
+
+// ---------------- False sharing ----------------------
+FalseSharingWorkload::FalseSharingWorkload(int core_id, uint64_t base, uint64_t blk_size, uint64_t word_size,
+                                           uint64_t num_lines, uint64_t count)
+    : base(base), blk_size(blk_size), word_offset(core_id * word_size),
+      num_lines(checked_count(num_lines, "FalseSharingWorkload", "num_lines must be > 0")), count(count) {
+    // every core's word must sit inside the shared block
+    require(core_id >= 0 && (uint64_t(core_id) + 1) * word_size <= blk_size, "FalseSharingWorkload", "core's word falls outside the block");
+}
+
+bool FalseSharingWorkload::next(Access& out) {
+    if (issued == count) return false;
+    uint64_t line = (issued / 2) % num_lines;
+    out.addr     = base + line * blk_size + word_offset;
+    out.is_write = (issued % 2 == 1);          // read, then write the same word
+    issued++;
+    return true;
+}
+
+// ---------------- Lock contention --------------------
+LockContentionWorkload::LockContentionWorkload(int core_id, uint64_t lock_addr, uint64_t cs_base, uint64_t blk_size,
+                                               uint64_t cs_lines, int max_spin, uint64_t count, uint64_t seed)
+    : lock_addr(lock_addr), cs_base(cs_base), blk_size(blk_size), cs_lines(cs_lines), count(count),
+      spin_count(1, std::max(max_spin, 1)), rng(seed + core_id) {
+    require(max_spin >= 1, "LockContentionWorkload", "max_spin must be >= 1");
+    spins = spin_count(rng);
+}
+
+bool LockContentionWorkload::next(Access& out) {
+    if (issued == count) return false;
+    switch (phase) {
+        case Phase::SPIN:        // test: read the lock until it looks free
+            out = Access{lock_addr, false};
+            if (--spins == 0) phase = Phase::ACQUIRE;
+            break;
+        case Phase::ACQUIRE:     // test-and-set
+            out = Access{lock_addr, true};
+            cs_line = 0;
+            phase = (cs_lines > 0) ? Phase::CS_READ : Phase::RELEASE;
+            break;
+        case Phase::CS_READ:
+            out = Access{cs_base + cs_line * blk_size, false};
+            phase = Phase::CS_WRITE;
+            break;
+        case Phase::CS_WRITE:
+            out = Access{cs_base + cs_line * blk_size, true};
+            phase = (++cs_line < cs_lines) ? Phase::CS_READ : Phase::RELEASE;
+            break;
+        case Phase::RELEASE:
+            out = Access{lock_addr, true};
+            spins = spin_count(rng);
+            phase = Phase::SPIN;
+            break;
+    }
+    issued++;
+    return true;
+}
+
+// -----------------------------------------------------
+//    OPEN LOOP DRIVER                                 |
+// -----------------------------------------------------
+WorkloadDriver::WorkloadDriver(EventSimulator& sim, ICache& cache, IWorkload& workload, uint64_t interval)
+    : sim(sim), cache(cache), workload(workload), interval(interval) {}
+
+void WorkloadDriver::start(uint64_t start_time) {
+    sim.schedule(start_time, [this](){ this->issue_next(); });
+}
+
+void WorkloadDriver::issue_next() {
+    Access acc;
+    if (!workload.next(acc)) return;
+
+    if (acc.is_write) cache.write(acc.addr);
+    else              cache.read(acc.addr);
+    num_issued++;
+
+    sim.schedule(sim.now() + interval, [this](){ this->issue_next(); });
+}
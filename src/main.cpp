@@ -4,11 +4,18 @@
 #include "Bus.hpp"
 #include "EventSimulator.hpp"
 #include "Logger.hpp"
+#include "Workload.hpp"
+#include "Core.hpp"
+#include "BusTrace.hpp"
+#include "TLB.hpp"
+#include "Arbiter.hpp"
+#include <fstream>
 
 int main() {
     EventSimulator sim;
     ConsoleLogger logger;
     Bus bus(sim, logger);
+    // bus.set_arbiter(std::make_unique<RoundRobinArbiter>());
 
     size_t blk_size = 64;
     size_t num_sets = 16;
@@ -23,6 +30,12 @@ int main() {
 
     Cache<MESICoherence, LRUEviction> L1A("L1A", blk_size, num_sets, assoc, mm_size, rd_hit_lt, rd_miss_lt, wr_hit_lt, wr_miss_lt, snoop_lt, snoop_hit_lt, sim, bus, logger); 
 
+    // Banked L1A: 4 block-interleaved banks, 1 read + 1 write port per bank per cycle
+    // L1A.configure_banks(4, 1, 1);
+
+    // 8-entry victim cache behind L1A, 2 cycle hit
+    // L1A.attach_victim_cache(8, 2);
+
     // Single cache read/write testing
     /*
     sim.schedule(0, [&](){ L1A.read(0x1000); });
@@ -60,6 +73,59 @@ int main() {
     sim.schedule(225, [&](){ L1B.read(0x4000); });
     */
 
+    // Synthetic workload testing (streams are pulled lazily, one access per 'interval')
+    /*
+    ZipfWorkload hot_set(0x0000, blk_size, 256, 0.9, 1000, 0.2, 42);
+    LockContentionWorkload lock_a(0, 0x8000, 0x9000, blk_size, 2, 4, 200);
+    LockContentionWorkload lock_b(1, 0x8000, 0x9000, blk_size, 2, 4, 200);
+    WorkloadDriver drv_hot(sim, L1A, hot_set, 20);
+    WorkloadDriver drv_a(sim, L1A, lock_a, 25);
+    WorkloadDriver drv_b(sim, L1B, lock_b, 25);
+    drv_hot.start(0);
+    drv_a.start(1);
+    drv_b.start(1);
+    */
+
+    // Closed loop cores (at most 4 outstanding accesses, 1 issue per cycle)
+    /*
+    UniformRandomWorkload rand_a(0x0000, blk_size, 0x4000, 1000, 0.1, 1);
+    UniformRandomWorkload rand_b(0x0000, blk_size, 0x4000, 1000, 0.1, 2);
+    Core core_a("A", sim, L1A, rand_a, 4);
+    Core core_b("B", sim, L1B, rand_b, 4);
+    core_a.start(0);
+    core_b.start(0);
+    */
+
+    // TLB in front of L1A (64 entries, 4-way, 4K pages, 16 entry page walk cache); walks go through L1A
+    /*
+    TLB tlb_a("A", 64, 4, PageSize::SIZE_4K, 16, 1, mm_size, sim, L1A, L1A, logger);
+    UniformRandomWorkload virt_a(0x0000, blk_size, 0x8000, 500, 0.1, 3);
+    Core tlb_core("A", sim, tlb_a, virt_a, 4);
+    tlb_core.start(0);
+    */
+
+    // Bus capture (record every bus request of this run to bus.trc)
+    /*
+    std::ofstream trace_out("bus.trc", std::ios::binary);
+    BusTraceWriter trace_writer(trace_out);
+    bus.set_capture(&trace_writer);
+    */
+
+    // Bus-side-only replay of bus.trc (comment out the caches and scenarios above)
+    /*
+    std::ifstream trace_in("bus.trc", std::ios::binary);
+    BusTraceReader trace_reader(trace_in);
+    BankedMemory dram(8, blk_size, 2048, 15, 40);
+    bus.set_memory(&dram);
+    BusReplayer replayer(sim, bus, trace_reader);
+    replayer.start();
+    */
+
     sim.run_sim();
+
+    // End of simulation latency report
+    L1A.print_stats(std::cout);
+    L1B.print_stats(std::cout);
+    bus.print_stats(std::cout);
     return 0;
 }